@@ -0,0 +1,143 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cmath>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+// Four-lane kernels for the stateless parts of the realtime effect chain. Each kernel
+// is written once against the small Float4 layer below, which maps to SSE2, NEON or
+// plain arrays. Leftover samples that don't fill a lane group go through the scalar
+// formula the voice used before, so short blocks stay exact. Carriers come from
+// QuadratureOscillator.
+namespace EffectKernels
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    using Float4 = __m128;
+
+    inline Float4 load (const float* p)               { return _mm_loadu_ps (p); }
+    inline void store (float* p, Float4 v)            { _mm_storeu_ps (p, v); }
+    inline Float4 splat (float v)                     { return _mm_set1_ps (v); }
+    inline Float4 lanes (float a, float b, float c, float d) { return _mm_setr_ps (a, b, c, d); }
+    inline Float4 add (Float4 a, Float4 b)            { return _mm_add_ps (a, b); }
+    inline Float4 sub (Float4 a, Float4 b)            { return _mm_sub_ps (a, b); }
+    inline Float4 mul (Float4 a, Float4 b)            { return _mm_mul_ps (a, b); }
+    inline Float4 div (Float4 a, Float4 b)            { return _mm_div_ps (a, b); }
+    inline Float4 min (Float4 a, Float4 b)            { return _mm_min_ps (a, b); }
+    inline Float4 max (Float4 a, Float4 b)            { return _mm_max_ps (a, b); }
+
+    // SSE2 has no floor: truncate, then step down where truncation rounded up.
+    inline Float4 floor (Float4 v)
+    {
+        const auto truncated = _mm_cvtepi32_ps (_mm_cvttps_epi32 (v));
+        return _mm_sub_ps (truncated, _mm_and_ps (_mm_cmpgt_ps (truncated, v), _mm_set1_ps (1.0f)));
+    }
+   #elif JUCE_USE_ARM_NEON
+    using Float4 = float32x4_t;
+
+    inline Float4 load (const float* p)               { return vld1q_f32 (p); }
+    inline void store (float* p, Float4 v)            { vst1q_f32 (p, v); }
+    inline Float4 splat (float v)                     { return vdupq_n_f32 (v); }
+    inline Float4 lanes (float a, float b, float c, float d) { const float v[4] { a, b, c, d }; return vld1q_f32 (v); }
+    inline Float4 add (Float4 a, Float4 b)            { return vaddq_f32 (a, b); }
+    inline Float4 sub (Float4 a, Float4 b)            { return vsubq_f32 (a, b); }
+    inline Float4 mul (Float4 a, Float4 b)            { return vmulq_f32 (a, b); }
+    inline Float4 min (Float4 a, Float4 b)            { return vminq_f32 (a, b); }
+    inline Float4 max (Float4 a, Float4 b)            { return vmaxq_f32 (a, b); }
+
+    #if defined (__aarch64__) || defined (_M_ARM64)
+    inline Float4 div (Float4 a, Float4 b)            { return vdivq_f32 (a, b); }
+    inline Float4 floor (Float4 v)                    { return vrndmq_f32 (v); }
+    #else
+    // 32-bit NEON has no divide and no floor. Divide lane by lane so the result stays
+    // exact, and floor the way the SSE2 branch does.
+    inline Float4 div (Float4 a, Float4 b)
+    {
+        float x[4], y[4];
+        vst1q_f32 (x, a);
+        vst1q_f32 (y, b);
+        for (int i = 0; i < 4; ++i)
+            x[i] /= y[i];
+        return vld1q_f32 (x);
+    }
+
+    inline Float4 floor (Float4 v)
+    {
+        const auto truncated = vcvtq_f32_s32 (vcvtq_s32_f32 (v));
+        const auto roundedUp = vandq_u32 (vcgtq_f32 (truncated, v), vreinterpretq_u32_f32 (vdupq_n_f32 (1.0f)));
+        return vsubq_f32 (truncated, vreinterpretq_f32_u32 (roundedUp));
+    }
+    #endif
+   #else
+    struct Float4 { float v[4]; };
+
+    template <typename Fn>
+    inline Float4 map (Float4 a, Float4 b, Fn&& fn)
+    {
+        Float4 r;
+        for (int i = 0; i < 4; ++i)
+            r.v[i] = fn (a.v[i], b.v[i]);
+        return r;
+    }
+
+    inline Float4 load (const float* p)               { return { { p[0], p[1], p[2], p[3] } }; }
+    inline void store (float* p, Float4 v)            { for (int i = 0; i < 4; ++i) p[i] = v.v[i]; }
+    inline Float4 splat (float v)                     { return { { v, v, v, v } }; }
+    inline Float4 lanes (float a, float b, float c, float d) { return { { a, b, c, d } }; }
+    inline Float4 add (Float4 a, Float4 b)            { return map (a, b, [] (float x, float y) { return x + y; }); }
+    inline Float4 sub (Float4 a, Float4 b)            { return map (a, b, [] (float x, float y) { return x - y; }); }
+    inline Float4 mul (Float4 a, Float4 b)            { return map (a, b, [] (float x, float y) { return x * y; }); }
+    inline Float4 div (Float4 a, Float4 b)            { return map (a, b, [] (float x, float y) { return x / y; }); }
+    inline Float4 min (Float4 a, Float4 b)            { return map (a, b, [] (float x, float y) { return y < x ? y : x; }); }
+    inline Float4 max (Float4 a, Float4 b)            { return map (a, b, [] (float x, float y) { return x < y ? y : x; }); }
+    inline Float4 floor (Float4 a)                    { return map (a, a, [] (float x, float) { return std::floor (x); }); }
+   #endif
+
+    inline Float4 clamp (Float4 v, float lo, float hi)
+    {
+        return min (max (v, splat (lo)), splat (hi));
+    }
+
+    // x *= dry + depth * carrier
+    inline void ringMod (float* x, const float* carrier, int numSamples, float dry, float depth)
+    {
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+            store (x + i, mul (load (x + i), add (splat (dry), mul (splat (depth), load (carrier + i)))));
+
+        for (; i < numSamples; ++i)
+            x[i] *= dry + depth * carrier[i];
+    }
+
+    // x = clamp (x * dry + x * carrier * wet, -1, 1)
+    inline void frequencyShift (float* x, const float* carrier, int numSamples, float dry, float wet)
+    {
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const auto in = load (x + i);
+            store (x + i, clamp (add (mul (in, splat (dry)), mul (mul (in, load (carrier + i)), splat (wet))), -1.0f, 1.0f));
+        }
+
+        for (; i < numSamples; ++i)
+            x[i] = juce::jlimit (-1.0f, 1.0f, x[i] * dry + x[i] * carrier[i] * wet);
+    }
+
+    // Bit-depth reduction of a bipolar signal onto `levels` steps.
+    inline void quantise (float* x, int numSamples, float levels)
+    {
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const auto scaled = floor (mul (add (mul (load (x + i), splat (0.5f)), splat (0.5f)), splat (levels)));
+            store (x + i, sub (mul (div (scaled, splat (levels)), splat (2.0f)), splat (1.0f)));
+        }
+
+        for (; i < numSamples; ++i)
+            x[i] = std::floor ((x[i] * 0.5f + 0.5f) * levels) / levels * 2.0f - 1.0f;
+    }
+}
@@ -445,7 +445,14 @@ void MainComponent::timerCallback()
         const juce::ScopedLock sl (udpStatusLock);
         udp = udpStatus;
     }
-    statusLabel.setText ("Status: " + audioStatus + " | " + udp + " | " + speechSource.getStatusText(), juce::dontSendNotification);
+
+    const auto queue = speechSource.getQueueStatusText();
+    if (queue.isNotEmpty())
+        udp << " | " << queue;
+
+    statusLabel.setText ("Status: " + audioStatus + " | " + udp + " | " + speechSource.getStatusText()
+                             + " | " + speechSource.getCacheStatusText(),
+                         juce::dontSendNotification);
 }
 
 void MainComponent::speakText (const juce::String& text)
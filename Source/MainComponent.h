@@ -16,6 +16,16 @@ public:
         return voice.getStatusText();
     }
 
+    juce::String getCacheStatusText() const
+    {
+        return voice.getCacheStatusText();
+    }
+
+    juce::String getQueueStatusText() const
+    {
+        return voice.getQueueStatusText();
+    }
+
     void setRealtimeControls (const SpeakNSpellVoice::RealtimeControls& controls)
     {
         voice.setRealtimeControls (controls);
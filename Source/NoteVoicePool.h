@@ -0,0 +1,240 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include "Pcm8Interpolator.h"
+
+// A fixed set of voices that replay one rendered utterance per MIDI note, repitched by
+// the note's distance from middle C. Everything lives in the pool from construction,
+// so note-ons and rendering never allocate. Audio thread only.
+//
+// When every allowed voice is busy a note-on steals one: the oldest voice that is
+// already fading out, otherwise the oldest voice. The stolen voice keeps fading over
+// the release time in one of the spare slots while the new note starts in another, so
+// stealing doesn't click.
+class NoteVoicePool
+{
+public:
+    static constexpr int maxVoices = 32;
+    static constexpr int rootNote = 60;
+
+    // Native PCM the caller keeps alive while isSourceInUse (id) is true.
+    struct Source
+    {
+        const uint8_t* data = nullptr;
+        size_t length = 0;
+        int id = -1;
+    };
+
+    void setSampleRate (double newSampleRate)
+    {
+        releaseStep = static_cast<float> (1.0 / (releaseSeconds * juce::jmax (8000.0, newSampleRate)));
+    }
+
+    void setVoiceLimit (int newLimit)
+    {
+        voiceLimit = juce::jlimit (1, maxVoices, newLimit);
+    }
+
+    int getVoiceLimit() const { return voiceLimit; }
+
+    // Looping voices repeat the utterance until their note is released; the others play
+    // it once and ignore note-off.
+    void noteOn (int note, float velocity, const Source& source, bool loop)
+    {
+        if (source.data == nullptr || source.length == 0)
+            return;
+
+        auto& voice = voices[static_cast<size_t> (findVoiceForNoteOn())];
+        voice.source = source;
+        voice.note = note;
+        voice.noteRatio = std::pow (2.0, static_cast<double> (note - rootNote) / 12.0);
+        voice.playhead = 0.0;
+        voice.gain = juce::jlimit (0.0f, 1.0f, velocity);
+        voice.fade = 1.0f;
+        voice.looping = loop;
+        voice.releasing = false;
+        voice.stolen = false;
+        voice.active = true;
+        voice.startedAt = ++noteCounter;
+    }
+
+    void noteOff (int note)
+    {
+        for (auto& voice : voices)
+            if (voice.active && voice.note == note && voice.looping)
+                voice.releasing = true;
+    }
+
+    void allNotesOff()
+    {
+        for (auto& voice : voices)
+            if (voice.active)
+                voice.releasing = true;
+    }
+
+    int getNumActiveVoices() const
+    {
+        int count = 0;
+        for (const auto& voice : voices)
+            count += voice.active && ! voice.stolen ? 1 : 0;
+        return count;
+    }
+
+    bool isSourceInUse (int id) const
+    {
+        for (const auto& voice : voices)
+            if (voice.active && voice.source.id == id)
+                return true;
+        return false;
+    }
+
+    // Adds every active voice into out. baseStep is the source samples per output sample
+    // shared by all notes, before each note's own transposition.
+    void render (float* out, int numSamples, double baseStep, const Pcm8Interpolator& interpolator)
+    {
+        for (auto& voice : voices)
+            if (voice.active)
+                renderVoice (voice, out, numSamples, baseStep, interpolator);
+    }
+
+private:
+    static constexpr double releaseSeconds = 0.01;
+    static constexpr int chunkSize = 64;
+
+    // Room for every allowed voice plus the tails of the ones stolen from them.
+    static constexpr int numSlots = maxVoices * 2;
+
+    struct Voice
+    {
+        Source source;
+        int note = -1;
+        double noteRatio = 1.0;
+        double playhead = 0.0;
+        float gain = 1.0f;
+        float fade = 1.0f;
+        bool looping = false;
+        bool releasing = false;
+        bool stolen = false;
+        bool active = false;
+        juce::uint32 startedAt = 0;
+    };
+
+    int findVoiceForNoteOn()
+    {
+        int numSounding = 0, freeVoice = -1;
+        for (int i = 0; i < numSlots; ++i)
+        {
+            const auto& voice = voices[static_cast<size_t> (i)];
+            if (voice.active && ! voice.stolen)
+                ++numSounding;
+            else if (! voice.active && freeVoice < 0)
+                freeVoice = i;
+        }
+
+        if (numSounding >= voiceLimit)
+            stealVoice();
+
+        if (freeVoice >= 0)
+            return freeVoice;
+
+        // Only reachable when more than maxVoices steals land within one release time:
+        // whichever voice is closest to silence is cut short.
+        int quietest = 0;
+        for (int i = 1; i < numSlots; ++i)
+            if (voices[static_cast<size_t> (i)].fade < voices[static_cast<size_t> (quietest)].fade)
+                quietest = i;
+
+        return quietest;
+    }
+
+    void stealVoice()
+    {
+        int oldest = -1, oldestReleasing = -1;
+        for (int i = 0; i < numSlots; ++i)
+        {
+            const auto& voice = voices[static_cast<size_t> (i)];
+            if (! voice.active || voice.stolen)
+                continue;
+
+            if (oldest < 0 || voice.startedAt < voices[static_cast<size_t> (oldest)].startedAt)
+                oldest = i;
+
+            if (voice.releasing && (oldestReleasing < 0 || voice.startedAt < voices[static_cast<size_t> (oldestReleasing)].startedAt))
+                oldestReleasing = i;
+        }
+
+        const auto victim = oldestReleasing >= 0 ? oldestReleasing : oldest;
+        if (victim < 0)
+            return;
+
+        auto& voice = voices[static_cast<size_t> (victim)];
+        voice.releasing = true;
+        voice.stolen = true;
+    }
+
+    // Runs in spans that end at the end of the utterance, so the inner loops only read.
+    void renderVoice (Voice& voice, float* out, int numSamples, double baseStep, const Pcm8Interpolator& interpolator)
+    {
+        const auto* data = voice.source.data;
+        const auto length = voice.source.length;
+        const auto size = static_cast<double> (length);
+        const auto step = juce::jlimit (0.05, 8.0, baseStep * voice.noteRatio);
+
+        for (int i = 0; i < numSamples;)
+        {
+            if (voice.playhead >= size)
+            {
+                if (! voice.looping || voice.releasing)
+                {
+                    voice.active = false;
+                    return;
+                }
+
+                voice.playhead = std::fmod (voice.playhead, size);
+            }
+
+            const auto remaining = static_cast<int> (std::ceil ((size - voice.playhead) / step));
+            const auto end = juce::jmin (numSamples, i + juce::jmax (1, remaining));
+            auto playhead = voice.playhead;
+
+            if (voice.releasing)
+            {
+                auto fade = voice.fade;
+                for (; i < end && fade > 0.0f; ++i)
+                {
+                    out[i] += interpolator.read (data, length, playhead) * voice.gain * fade;
+                    playhead += step;
+                    fade -= releaseStep;
+                }
+
+                voice.playhead = playhead;
+                voice.fade = fade;
+                if (fade <= 0.0f)
+                {
+                    voice.active = false;
+                    return;
+                }
+
+                continue;
+            }
+
+            for (; i < end; i += chunkSize)
+            {
+                float chunk[chunkSize];
+                const auto count = juce::jmin (chunkSize, end - i);
+                playhead = interpolator.process (data, length, playhead, step, chunk, count);
+                juce::FloatVectorOperations::addWithMultiply (out + i, chunk, voice.gain, count);
+            }
+
+            voice.playhead = playhead;
+            i = end;
+        }
+    }
+
+    std::array<Voice, numSlots> voices {};
+    int voiceLimit = 16;
+    juce::uint32 noteCounter = 0;
+    float releaseStep = static_cast<float> (1.0 / (releaseSeconds * 44100.0));
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include "PolyphaseResampler.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+// Reads SAM's unsigned 8-bit PCM at any fractional source position through the
+// Kaiser-windowed sinc kernels from PolyphaseResampler, decoding the bytes inside the
+// dot product. This lets the voice keep phrases in their native form and resample them only
+// as they play. Positions outside the buffer read as silence.
+//
+// process() is the block form: it writes into a caller-owned buffer and returns where
+// the next block starts, so a phrase can be converted a chunk at a time with no state
+// beyond the position.
+class Pcm8Interpolator
+{
+public:
+    void prepare (double sourceRate, double targetRate, PolyphaseResampler::Quality quality)
+    {
+        kernel = quality == PolyphaseResampler::Quality::linear
+                     ? nullptr
+                     : PolyphaseResampler::getKernel (sourceRate, targetRate, quality);
+        jassert (kernel == nullptr || kernel->numPhases == 1 << phaseBits);
+    }
+
+    float read (const uint8_t* pcm, size_t numSamples, double position) const
+    {
+        if (kernel == nullptr)
+            return readLinear (pcm, numSamples, position);
+
+        // Round to the nearest of the kernel's phases; the phase count is a power of two,
+        // so one integer splits into the input sample and the phase.
+        const auto& k = *kernel;
+        const auto scaled = position * k.numPhases + 0.5;
+        const auto index = scaled >= 0.0 ? static_cast<int64_t> (scaled) : static_cast<int64_t> (std::floor (scaled));
+        const auto centre = index >> phaseBits;
+        const auto phase = static_cast<int> (index & (k.numPhases - 1));
+
+        const auto first = centre + k.numTaps / 2 - k.numTaps + 1;
+        const auto* coeffs = k.coeffs.data() + static_cast<size_t> (phase) * static_cast<size_t> (k.numTaps);
+
+        // Every phase sums to one, so the -128 offset of each byte comes out as -0.5.
+        if (first >= 0 && first + k.numTaps <= static_cast<int64_t> (numSamples))
+            return dot (pcm + first, coeffs, k.numTaps) * (1.0f / 256.0f) - 0.5f;
+
+        if (first >= static_cast<int64_t> (numSamples) || first + k.numTaps <= 0)
+            return 0.0f;
+
+        return dotClipped (pcm, static_cast<int64_t> (numSamples), first, coeffs, k.numTaps);
+    }
+
+    double process (const uint8_t* pcm, size_t numSamples, double position, double step, float* out, int numOut) const
+    {
+        int i = 0;
+        while (i < numOut)
+        {
+            const auto run = kernel != nullptr ? getInteriorRun (numSamples, position, step, numOut - i) : 0;
+            if (run > 0)
+            {
+                processInterior (pcm, position, step, out + i, run);
+                position += step * run;
+                i += run;
+                continue;
+            }
+
+            out[i++] = read (pcm, numSamples, position);
+            position += step;
+        }
+
+        return position;
+    }
+
+    static float decode (uint8_t sample)
+    {
+        return (static_cast<float> (sample) - 128.0f) / 256.0f;
+    }
+
+private:
+    static constexpr int phaseBits = 10;
+    static constexpr int fractionBits = 32;
+
+    // How many of the next outputs read only inside the buffer.
+    int getInteriorRun (size_t numSamples, double position, double step, int maxRun) const
+    {
+        const auto half = kernel->numTaps / 2;
+        const auto lo = static_cast<double> (half);
+        const auto hi = static_cast<double> (numSamples) - half - 2;
+        if (position < lo || position >= hi)
+            return 0;
+
+        return static_cast<int> (juce::jmin (static_cast<double> (maxRun), std::ceil ((hi - position) / step)));
+    }
+
+    // Steps a 32.32 fixed-point position, so finding the sample and phase per output is
+    // a shift and a mask.
+    void processInterior (const uint8_t* pcm, double position, double step, float* out, int numOut) const
+    {
+        const auto& k = *kernel;
+        const auto taps = k.numTaps;
+        const auto offset = taps / 2 - taps + 1;
+        const auto* coeffs = k.coeffs.data();
+
+        constexpr auto roundShift = fractionBits - phaseBits;
+        auto fixed = static_cast<uint64_t> (position * 4294967296.0) + (uint64_t { 1 } << (roundShift - 1));
+        const auto fixedStep = static_cast<uint64_t> (step * 4294967296.0);
+
+        for (int i = 0; i < numOut; ++i)
+        {
+            const auto index = fixed >> roundShift;
+            const auto centre = static_cast<int64_t> (index >> phaseBits);
+            const auto phase = static_cast<size_t> (index & ((1u << phaseBits) - 1));
+            out[i] = dot (pcm + centre + offset, coeffs + phase * static_cast<size_t> (taps), taps) * (1.0f / 256.0f) - 0.5f;
+            fixed += fixedStep;
+        }
+    }
+
+    static float readLinear (const uint8_t* pcm, size_t numSamples, double position)
+    {
+        const auto i0 = position >= 0.0 ? static_cast<int64_t> (position) : static_cast<int64_t> (std::floor (position));
+        const auto frac = static_cast<float> (position - static_cast<double> (i0));
+        const auto at = [&] (int64_t i) { return i >= 0 && i < static_cast<int64_t> (numSamples) ? decode (pcm[i]) : 0.0f; };
+        const auto a = at (i0);
+        return a + (at (i0 + 1) - a) * frac;
+    }
+
+    // Kernels are a multiple of eight taps long: eight bytes are widened to two lanes of
+    // four floats per step.
+    static float dot (const uint8_t* x, const float* c, int n)
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        const auto zero = _mm_setzero_si128();
+        auto acc0 = _mm_setzero_ps();
+        auto acc1 = _mm_setzero_ps();
+        for (int i = 0; i < n; i += 8)
+        {
+            const auto bytes = _mm_unpacklo_epi8 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (x + i)), zero);
+            acc0 = _mm_add_ps (acc0, _mm_mul_ps (_mm_cvtepi32_ps (_mm_unpacklo_epi16 (bytes, zero)), _mm_loadu_ps (c + i)));
+            acc1 = _mm_add_ps (acc1, _mm_mul_ps (_mm_cvtepi32_ps (_mm_unpackhi_epi16 (bytes, zero)), _mm_loadu_ps (c + i + 4)));
+        }
+        acc0 = _mm_add_ps (acc0, acc1);
+        acc0 = _mm_add_ps (acc0, _mm_movehl_ps (acc0, acc0));
+        return _mm_cvtss_f32 (_mm_add_ss (acc0, _mm_shuffle_ps (acc0, acc0, 1)));
+       #elif JUCE_USE_ARM_NEON
+        auto acc0 = vdupq_n_f32 (0.0f);
+        auto acc1 = vdupq_n_f32 (0.0f);
+        for (int i = 0; i < n; i += 8)
+        {
+            const auto bytes = vmovl_u8 (vld1_u8 (x + i));
+            acc0 = vmlaq_f32 (acc0, vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (bytes))), vld1q_f32 (c + i));
+            acc1 = vmlaq_f32 (acc1, vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (bytes))), vld1q_f32 (c + i + 4));
+        }
+        acc0 = vaddq_f32 (acc0, acc1);
+        return (vgetq_lane_f32 (acc0, 0) + vgetq_lane_f32 (acc0, 1)) + (vgetq_lane_f32 (acc0, 2) + vgetq_lane_f32 (acc0, 3));
+       #else
+        float sum = 0.0f;
+        for (int i = 0; i < n; ++i)
+            sum += static_cast<float> (x[i]) * c[i];
+        return sum;
+       #endif
+    }
+
+    static float dotClipped (const uint8_t* pcm, int64_t numSamples, int64_t first, const float* c, int n)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < n; ++i)
+        {
+            const auto idx = first + i;
+            if (idx >= 0 && idx < numSamples)
+                sum += decode (pcm[idx]) * c[i];
+        }
+        return sum;
+    }
+
+    std::shared_ptr<const PolyphaseResampler::Kernel> kernel;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Recycles the render worker's PCM buffers so a steady stream of phrases reuses the
+// same allocations instead of fragmenting the heap. The pool keeps one reference to
+// every buffer it has handed out; once the playback slots, note sources and cache have
+// all let go, the count is back to one and the buffer is free again, capacity intact.
+// The audio thread never drops the last reference to a buffer, so nothing has to tell
+// the pool when playback has finished with one.
+//
+// acquire() and reserve() belong to the worker thread. A buffer it has handed out may be
+// filled on another thread while that thread holds a reference. getStats() may be called
+// from anywhere.
+class PcmBufferPool
+{
+public:
+    using Buffer = std::shared_ptr<std::vector<uint8_t>>;
+
+    struct Stats
+    {
+        uint64_t reuses = 0;        // acquires served by a free buffer that was big enough
+        uint64_t allocations = 0;   // new buffers, plus every time a buffer had to grow
+        uint64_t released = 0;      // free buffers given back to the heap over the budget
+        size_t buffers = 0;
+        size_t bytes = 0;
+    };
+
+    explicit PcmBufferPool (size_t maxFreeBytesIn = 8 * 1024 * 1024)
+        : maxFreeBytes (maxFreeBytesIn)
+    {
+        entries.reserve (initialEntries);
+    }
+
+    // Returns an empty buffer that can take at least minCapacity bytes. Picks the
+    // smallest free buffer that fits, else grows the largest free one.
+    Buffer acquire (size_t minCapacity)
+    {
+        return acquire (minCapacity, std::numeric_limits<size_t>::max(), false);
+    }
+
+    // As acquire(), but the capacity is at most an eighth over size, for data that is
+    // kept long after the render, such as cache entries. Fitted buffers are recycled
+    // among themselves, so render buffers never grow into them or the other way round.
+    Buffer acquireFitted (size_t size)
+    {
+        return acquire (size, size + size / 8, true);
+    }
+
+    // Makes room for at least minCapacity bytes in a buffer from acquire(), growing it
+    // geometrically so a buffer filled a piece at a time reallocates only a few times.
+    void reserve (const Buffer& buffer, size_t minCapacity)
+    {
+        if (buffer->capacity() >= minCapacity)
+            return;
+
+        buffer->reserve (juce::jmax (minCapacity, buffer->capacity() * 2));
+        for (auto& entry : entries)
+            if (entry.buffer == buffer)
+                noteGrowth (entry);
+    }
+
+    Stats getStats() const
+    {
+        Stats s;
+        s.reuses = reuses.load();
+        s.allocations = allocations.load();
+        s.released = released.load();
+        s.buffers = numBuffers.load();
+        s.bytes = totalBytes.load();
+        return s;
+    }
+
+private:
+    static constexpr size_t initialEntries = 256;
+
+    struct Entry
+    {
+        Buffer buffer;
+        size_t capacity = 0;
+        bool fitted = false;
+    };
+
+    // Free buffers with more than maxCapacity, or from the other group, are passed over.
+    Buffer acquire (size_t minCapacity, size_t maxCapacity, bool fitted)
+    {
+        Entry* best = nullptr;
+        Entry* largest = nullptr;
+        size_t freeBytes = 0;
+
+        // Pairs with the release in whichever thread dropped the last other reference.
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        for (auto& entry : entries)
+        {
+            if (entry.buffer.use_count() != 1)
+                continue;
+
+            noteGrowth (entry);
+            freeBytes += entry.capacity;
+            if (entry.fitted != fitted || entry.capacity > maxCapacity)
+                continue;
+            if (entry.capacity >= minCapacity && (best == nullptr || entry.capacity < best->capacity))
+                best = &entry;
+            if (largest == nullptr || entry.capacity > largest->capacity)
+                largest = &entry;
+        }
+
+        auto* chosen = best != nullptr ? best : largest;
+        if (chosen == nullptr)
+        {
+            entries.push_back ({ std::make_shared<std::vector<uint8_t>>(), 0, fitted });
+            chosen = &entries.back();
+        }
+        else
+        {
+            freeBytes -= chosen->capacity;
+        }
+
+        auto buffer = chosen->buffer;
+        buffer->clear();
+        if (buffer->capacity() < minCapacity)
+            buffer->reserve (minCapacity);
+
+        if (chosen->capacity == buffer->capacity() && chosen->capacity > 0)
+            reuses.fetch_add (1);
+        else
+            noteGrowth (*chosen);
+
+        trimFreeBuffers (freeBytes);
+        publishSize();
+        return buffer;
+    }
+
+    // Growth outside reserve(), such as an assign() into the buffer or a render on another
+    // thread, is counted once the buffer is free again and nothing else can be resizing it.
+    void noteGrowth (Entry& entry)
+    {
+        const auto capacity = entry.buffer->capacity();
+        if (capacity > entry.capacity)
+            allocations.fetch_add (1);
+        entry.capacity = capacity;
+    }
+
+    void trimFreeBuffers (size_t freeBytes)
+    {
+        for (size_t i = entries.size(); i-- > 0 && freeBytes > maxFreeBytes;)
+        {
+            auto& entry = entries[i];
+            if (entry.buffer.use_count() != 1)
+                continue;
+
+            freeBytes -= entry.capacity;
+            if (i + 1 < entries.size())
+                entry = std::move (entries.back());
+            entries.pop_back();
+            released.fetch_add (1);
+        }
+    }
+
+    void publishSize()
+    {
+        size_t bytes = 0;
+        for (const auto& entry : entries)
+            bytes += entry.capacity;
+
+        numBuffers.store (entries.size());
+        totalBytes.store (bytes);
+    }
+
+    std::vector<Entry> entries;
+    const size_t maxFreeBytes;
+    std::atomic<uint64_t> reuses { 0 };
+    std::atomic<uint64_t> allocations { 0 };
+    std::atomic<uint64_t> released { 0 };
+    std::atomic<size_t> numBuffers { 0 };
+    std::atomic<size_t> totalBytes { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (PcmBufferPool)
+};
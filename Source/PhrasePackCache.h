@@ -0,0 +1,457 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Content-addressed on-disk cache of native-rate SAM output (unsigned 8-bit at
+// SamEngine::outputSampleRate), kept in one pack file so phrases survive restarts.
+//
+// Layout (little-endian):
+//   header  64 bytes   "SAMPACK1", version, index slot count, data end, generation, entry count
+//   index   slots x 16 key hash, record offset (0 = empty), open addressing
+//   data    records    'SREC', key length, pcm length, key hash, key bytes, pcm bytes
+//
+// Lookups read through a memory mapping; writers append a record and then publish it
+// in the index and header, so a reader never sees a half-written entry. When the data
+// region would exceed the size cap, or the index gets too full, the newest records are
+// compacted to the front and the generation bumps, telling other mappings to refresh.
+// All access is serialised by a process-wide lock plus a named inter-process lock,
+// so several plugin instances, in one host or many, can share the file. The file is
+// never truncated while it may be mapped: a damaged pack is replaced by renaming a
+// fresh one over it.
+class PhrasePackCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t compactions = 0;
+    };
+
+    explicit PhrasePackCache (juce::File packFileIn, juce::int64 maxDataBytesIn = 128 * 1024 * 1024)
+        : packFile (std::move (packFileIn)),
+          maxDataBytes (maxDataBytesIn)
+    {
+    }
+
+    // The layout version is part of the name, so builds that disagree on it never open,
+    // and so never replace, each other's pack.
+    static juce::File getDefaultFile()
+    {
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                   .getChildFile ("SAMVoiceSynth")
+                   .getChildFile ("phrase-cache-v" + juce::String (static_cast<int> (packVersion)) + ".pack");
+    }
+
+    bool lookup (const std::string& key, std::vector<uint8_t>& pcm)
+    {
+        const juce::ScopedLock processLock (getProcessLock());
+        const juce::InterProcessLock::ScopedLockType fileLock (interProcessLock);
+        if (! fileLock.isLocked() || ! refreshMapping())
+        {
+            ++misses;
+            return false;
+        }
+
+        const auto record = findRecord (key, hashKey (key));
+        if (record.pcm == nullptr)
+        {
+            ++misses;
+            return false;
+        }
+
+        pcm.assign (record.pcm, record.pcm + record.pcmSize);
+        ++hits;
+        return true;
+    }
+
+    void store (const std::string& key, const uint8_t* pcm, size_t pcmSize)
+    {
+        const auto keyHash = hashKey (key);
+        const auto recordSize = static_cast<juce::int64> (recordHeaderSize + key.size() + pcmSize);
+        if (pcm == nullptr || pcmSize == 0 || recordSize > maxDataBytes / 2)
+            return;
+
+        const juce::ScopedLock processLock (getProcessLock());
+        const juce::InterProcessLock::ScopedLockType fileLock (interProcessLock);
+        if (! fileLock.isLocked() || ! refreshMapping())
+            return;
+
+        if (findRecord (key, keyHash).pcm != nullptr)
+            return;
+
+        auto header = readHeader();
+        if (header.dataEnd + recordSize > dataStart() + maxDataBytes || header.entryCount + 1 > indexSlots * 3 / 4)
+        {
+            if (! compact() || ! refreshMapping())
+                return;
+            header = readHeader();
+        }
+
+        juce::FileOutputStream out (packFile);
+        if (! out.openedOk() || ! out.setPosition (header.dataEnd))
+            return;
+
+        out.writeInt (static_cast<int> (recordMagic));
+        out.writeInt (static_cast<int> (key.size()));
+        out.writeInt (static_cast<int> (pcmSize));
+        out.writeInt64 (static_cast<juce::int64> (keyHash));
+        out.write (key.data(), key.size());
+        out.write (pcm, pcmSize);
+        out.flush();
+
+        const auto slot = findFreeSlot (keyHash);
+        if (slot < 0)
+            return;
+
+        out.setPosition (indexOffset + slot * slotSize);
+        out.writeInt64 (static_cast<juce::int64> (keyHash));
+        out.writeInt64 (header.dataEnd);
+        out.flush();
+
+        header.dataEnd += recordSize;
+        ++header.entryCount;
+        writeHeader (out, header);
+    }
+
+    Stats getStats() const
+    {
+        Stats s;
+        s.hits = hits.load();
+        s.misses = misses.load();
+        s.compactions = compactions.load();
+        return s;
+    }
+
+private:
+    struct Header
+    {
+        juce::int64 dataEnd = 0;
+        juce::int64 generation = 0;
+        juce::int64 entryCount = 0;
+    };
+
+    struct RecordView
+    {
+        const uint8_t* pcm = nullptr;
+        size_t pcmSize = 0;
+    };
+
+    static constexpr char packMagic[] = "SAMPACK1";
+    // Version 1 packs may hold unsplit renders of multi-sentence phrases, which playback
+    // stitches sentence by sentence.
+    static constexpr uint32_t packVersion = 2;
+    static constexpr uint32_t recordMagic = 0x43455253; // "SREC"
+    static constexpr juce::int64 headerSize = 64;
+    static constexpr juce::int64 indexOffset = headerSize;
+    static constexpr juce::int64 indexSlots = 8192;
+    static constexpr juce::int64 slotSize = 16;
+    static constexpr juce::int64 recordHeaderSize = 20;
+
+    static constexpr juce::int64 dataStart()
+    {
+        return indexOffset + indexSlots * slotSize;
+    }
+
+    static juce::CriticalSection& getProcessLock()
+    {
+        static juce::CriticalSection lock;
+        return lock;
+    }
+
+    static uint64_t hashKey (const std::string& key)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const auto c : key)
+        {
+            hash ^= static_cast<uint8_t> (c);
+            hash *= 1099511628211ull;
+        }
+        return hash == 0 ? 1 : hash;
+    }
+
+    static uint64_t readU64 (const uint8_t* p)
+    {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i)
+            v = (v << 8) | p[i];
+        return v;
+    }
+
+    static uint32_t readU32 (const uint8_t* p)
+    {
+        return static_cast<uint32_t> (p[0]) | (static_cast<uint32_t> (p[1]) << 8)
+             | (static_cast<uint32_t> (p[2]) << 16) | (static_cast<uint32_t> (p[3]) << 24);
+    }
+
+    const uint8_t* mappedBytes() const
+    {
+        return static_cast<const uint8_t*> (mapping->getData());
+    }
+
+    Header readHeader() const
+    {
+        const auto* p = mappedBytes();
+        Header h;
+        h.dataEnd = static_cast<juce::int64> (readU64 (p + 16));
+        h.generation = static_cast<juce::int64> (readU64 (p + 24));
+        h.entryCount = static_cast<juce::int64> (readU32 (p + 32));
+        return h;
+    }
+
+    void writeHeader (juce::FileOutputStream& out, const Header& h) const
+    {
+        out.setPosition (0);
+        out.write (packMagic, 8);
+        out.writeInt (static_cast<int> (packVersion));
+        out.writeInt (static_cast<int> (indexSlots));
+        out.writeInt64 (h.dataEnd);
+        out.writeInt64 (h.generation);
+        out.writeInt (static_cast<int> (h.entryCount));
+        out.flush();
+    }
+
+    // Other processes may have the old file mapped, so it is never rewritten in place:
+    // the empty pack is built beside it and renamed over it, and their mappings keep the
+    // old file alive. Clearing the old file's magic first sends them back to the path.
+    bool createEmptyPack()
+    {
+        mapping.reset();
+        packFile.getParentDirectory().createDirectory();
+
+        const auto fresh = packFile.getSiblingFile (packFile.getFileName() + ".new");
+        {
+            juce::FileOutputStream out (fresh);
+            if (! out.openedOk() || ! out.setPosition (0) || out.truncate().failed())
+                return false;
+
+            std::vector<char> zeros (static_cast<size_t> (dataStart()), 0);
+            out.write (zeros.data(), zeros.size());
+            Header h;
+            h.dataEnd = dataStart();
+            writeHeader (out, h);
+        }
+
+        if (packFile.existsAsFile())
+        {
+            juce::FileOutputStream old (packFile);
+            if (old.openedOk() && old.setPosition (0))
+            {
+                const char noMagic[8] {};
+                old.write (noMagic, sizeof (noMagic));
+                old.flush();
+            }
+        }
+
+        if (! fresh.replaceFileIn (packFile))
+        {
+            fresh.deleteFile();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool headerLooksValid() const
+    {
+        if (mapping == nullptr || mapping->getData() == nullptr || static_cast<juce::int64> (mapping->getSize()) < dataStart())
+            return false;
+
+        const auto* p = mappedBytes();
+        return std::memcmp (p, packMagic, 8) == 0
+            && readU32 (p + 8) == packVersion
+            && readU32 (p + 12) == static_cast<uint32_t> (indexSlots);
+    }
+
+    // Called with both locks held. Re-maps when the file has grown past the mapping,
+    // another process compacted or replaced it, and creates a new pack if it is missing
+    // or damaged.
+    bool refreshMapping()
+    {
+        if (headerLooksValid())
+        {
+            const auto header = readHeader();
+            if (header.generation == mappedGeneration && header.dataEnd <= static_cast<juce::int64> (mapping->getSize()))
+                return true;
+        }
+
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            mapping.reset();
+            if (packFile.existsAsFile())
+                mapping = std::make_unique<juce::MemoryMappedFile> (packFile, juce::MemoryMappedFile::readOnly);
+
+            if (headerLooksValid() && readHeader().dataEnd <= static_cast<juce::int64> (mapping->getSize()))
+            {
+                mappedGeneration = readHeader().generation;
+                return true;
+            }
+
+            if (attempt == 0 && ! createEmptyPack())
+                break;
+        }
+
+        mapping.reset();
+        return false;
+    }
+
+    RecordView recordAt (juce::int64 offset, juce::int64 dataEnd, const std::string* key) const
+    {
+        if (offset < dataStart() || offset + recordHeaderSize > dataEnd)
+            return {};
+
+        const auto* p = mappedBytes() + offset;
+        const auto keySize = static_cast<juce::int64> (readU32 (p + 4));
+        const auto pcmSize = static_cast<juce::int64> (readU32 (p + 8));
+        if (readU32 (p) != recordMagic || offset + recordHeaderSize + keySize + pcmSize > dataEnd)
+            return {};
+
+        const auto* keyBytes = p + recordHeaderSize;
+        if (key != nullptr && (static_cast<size_t> (keySize) != key->size() || std::memcmp (keyBytes, key->data(), key->size()) != 0))
+            return {};
+
+        return { keyBytes + keySize, static_cast<size_t> (pcmSize) };
+    }
+
+    RecordView findRecord (const std::string& key, uint64_t keyHash) const
+    {
+        const auto header = readHeader();
+        const auto* index = mappedBytes() + indexOffset;
+
+        for (juce::int64 probe = 0; probe < indexSlots; ++probe)
+        {
+            const auto slot = static_cast<juce::int64> ((keyHash + static_cast<uint64_t> (probe)) % static_cast<uint64_t> (indexSlots));
+            const auto* entry = index + slot * slotSize;
+            const auto offset = static_cast<juce::int64> (readU64 (entry + 8));
+            if (offset == 0)
+                return {};
+
+            if (readU64 (entry) == keyHash)
+                if (const auto record = recordAt (offset, header.dataEnd, &key); record.pcm != nullptr)
+                    return record;
+        }
+
+        return {};
+    }
+
+    juce::int64 findFreeSlot (uint64_t keyHash) const
+    {
+        const auto* index = mappedBytes() + indexOffset;
+        for (juce::int64 probe = 0; probe < indexSlots; ++probe)
+        {
+            const auto slot = static_cast<juce::int64> ((keyHash + static_cast<uint64_t> (probe)) % static_cast<uint64_t> (indexSlots));
+            if (readU64 (index + slot * slotSize + 8) == 0)
+                return slot;
+        }
+        return -1;
+    }
+
+    // Keeps the newest records that fit in half the size cap and half the index, moves
+    // them to the front of the data region and rebuilds the index. The file itself is
+    // never truncated, so mappings held elsewhere stay valid until they refresh.
+    bool compact()
+    {
+        const auto header = readHeader();
+
+        struct Live
+        {
+            juce::int64 offset;
+            juce::int64 size;
+            uint64_t keyHash;
+        };
+
+        std::vector<Live> records;
+        for (auto offset = dataStart(); offset < header.dataEnd;)
+        {
+            const auto record = recordAt (offset, header.dataEnd, nullptr);
+            if (record.pcm == nullptr)
+                break;
+
+            const auto* p = mappedBytes() + offset;
+            const auto size = recordHeaderSize + static_cast<juce::int64> (readU32 (p + 4)) + static_cast<juce::int64> (readU32 (p + 8));
+            records.push_back ({ offset, size, readU64 (p + 12) });
+            offset += size;
+        }
+
+        juce::int64 keptBytes = 0;
+        auto firstKept = records.size();
+        while (firstKept > 0)
+        {
+            const auto& candidate = records[firstKept - 1];
+            if (keptBytes + candidate.size > maxDataBytes / 2 || static_cast<juce::int64> (records.size() - firstKept) + 1 > indexSlots / 2)
+                break;
+            keptBytes += candidate.size;
+            --firstKept;
+        }
+
+        std::vector<uint8_t> kept;
+        kept.reserve (static_cast<size_t> (keptBytes));
+        for (auto i = firstKept; i < records.size(); ++i)
+        {
+            const auto* p = mappedBytes() + records[i].offset;
+            kept.insert (kept.end(), p, p + records[i].size);
+        }
+
+        std::vector<uint8_t> index (static_cast<size_t> (indexSlots * slotSize), 0);
+        auto offset = dataStart();
+        for (auto i = firstKept; i < records.size(); ++i)
+        {
+            for (juce::int64 probe = 0; probe < indexSlots; ++probe)
+            {
+                const auto slot = static_cast<size_t> ((records[i].keyHash + static_cast<uint64_t> (probe)) % static_cast<uint64_t> (indexSlots));
+                auto* entry = index.data() + slot * static_cast<size_t> (slotSize);
+                if (readU64 (entry + 8) != 0)
+                    continue;
+
+                for (int b = 0; b < 8; ++b)
+                {
+                    entry[b] = static_cast<uint8_t> (records[i].keyHash >> (8 * b));
+                    entry[8 + b] = static_cast<uint8_t> (static_cast<uint64_t> (offset) >> (8 * b));
+                }
+                break;
+            }
+            offset += records[i].size;
+        }
+
+        juce::FileOutputStream out (packFile);
+        if (! out.openedOk())
+            return false;
+
+        // Invalidate first: if we die half-way, readers find an empty index, not stale offsets.
+        Header next;
+        next.dataEnd = dataStart();
+        next.generation = header.generation + 1;
+        writeHeader (out, next);
+
+        out.setPosition (indexOffset);
+        out.write (index.data(), index.size());
+        out.write (kept.data(), kept.size());
+        out.flush();
+
+        next.dataEnd = dataStart() + keptBytes;
+        next.entryCount = static_cast<juce::int64> (records.size() - firstKept);
+        writeHeader (out, next);
+
+        // Force our own mapping to be rebuilt from the rewritten file.
+        mappedGeneration = -1;
+        ++compactions;
+        return true;
+    }
+
+    juce::File packFile;
+    juce::int64 maxDataBytes;
+    juce::InterProcessLock interProcessLock { "SAMVoiceSynthPhrasePack" };
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    juce::int64 mappedGeneration = -1;
+
+    std::atomic<uint64_t> hits { 0 };
+    std::atomic<uint64_t> misses { 0 };
+    std::atomic<uint64_t> compactions { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (PhrasePackCache)
+};
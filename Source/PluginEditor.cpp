@@ -31,7 +31,11 @@ SAMVoiceSynthesizerAudioProcessorEditor::SAMVoiceSynthesizerAudioProcessorEditor
     };
     addAndMakeVisible (presetBox);
 
-    auto setupSlider = [this] (juce::Slider& s, juce::Label& l, const juce::String& name, int mn, int mx, int dv)
+    // Each control is attached to its parameter, which sets its range, keeps it in step
+    // with automation and wraps edits in change gestures for the host.
+    auto& parameters = samProcessor.getParameterState();
+
+    auto setupSlider = [this, &parameters] (juce::Slider& s, juce::Label& l, const juce::String& name, const juce::String& parameterId)
     {
         l.setText (name.toUpperCase(), juce::dontSendNotification);
         l.setFont (juce::FontOptions ("Verdana", 12.0f, juce::Font::bold));
@@ -40,8 +44,6 @@ SAMVoiceSynthesizerAudioProcessorEditor::SAMVoiceSynthesizerAudioProcessorEditor
 
         s.setSliderStyle (juce::Slider::LinearHorizontal);
         s.setTextBoxStyle (juce::Slider::TextBoxRight, false, 56, 20);
-        s.setRange (mn, mx, 1.0);
-        s.setValue (dv, juce::dontSendNotification);
         s.setColour (juce::Slider::backgroundColourId, juce::Colour::fromRGB (255, 230, 178));
         s.setColour (juce::Slider::trackColourId, juce::Colour::fromRGB (255, 122, 98));
         s.setColour (juce::Slider::thumbColourId, juce::Colour::fromRGB (78, 201, 255));
@@ -49,40 +51,37 @@ SAMVoiceSynthesizerAudioProcessorEditor::SAMVoiceSynthesizerAudioProcessorEditor
         s.setColour (juce::Slider::textBoxTextColourId, juce::Colour::fromRGB (40, 36, 60));
         s.setColour (juce::Slider::textBoxOutlineColourId, juce::Colour::fromRGB (84, 78, 120));
         addAndMakeVisible (s);
+        sliderAttachments.push_back (std::make_unique<SliderAttachment> (parameters, parameterId, s));
     };
 
-    setupSlider (speedSlider, speedLabel, "Speed", 1, 255, 72);
-    setupSlider (pitchSlider, pitchLabel, "Pitch", 0, 255, 64);
-    setupSlider (mouthSlider, mouthLabel, "Mouth", 0, 255, 128);
-    setupSlider (throatSlider, throatLabel, "Throat", 0, 255, 128);
-    setupSlider (rtSpeedSlider, rtSpeedLabel, "Playback Speed", 25, 200, 100);
-    setupSlider (rtPitchSlider, rtPitchLabel, "Repitch (st)", -24, 24, 0);
-    setupSlider (formantSlider, formantLabel, "Formant Warp", 0, 100, 0);
-    setupSlider (gateSlider, gateLabel, "Glitch Gate", 0, 100, 0);
-    setupSlider (crushSlider, crushLabel, "Bit Crush", 0, 100, 0);
-    setupSlider (loopSlider, loopLabel, "Micro Loop", 0, 100, 0);
-    setupSlider (tiltSlider, tiltLabel, "Spectral Tilt", 0, 100, 50);
-    setupSlider (ringSlider, ringLabel, "Ring Mod", 0, 100, 0);
-    setupSlider (shiftSlider, shiftLabel, "Freq Shift", 0, 100, 0);
-    setupSlider (jitterSlider, jitterLabel, "Repitch Jitter", 0, 100, 0);
-    setupSlider (mutationSlider, mutationLabel, "Phoneme Mutation", 0, 100, 0);
-    rtSpeedSlider.setTextValueSuffix (" %");
-
-    auto updateRealtime = [this]
-    {
-        samProcessor.setRealtimeControls (gatherRealtimeControls());
-    };
-    rtSpeedSlider.onValueChange = updateRealtime;
-    rtPitchSlider.onValueChange = updateRealtime;
-    formantSlider.onValueChange = updateRealtime;
-    gateSlider.onValueChange = updateRealtime;
-    crushSlider.onValueChange = updateRealtime;
-    loopSlider.onValueChange = updateRealtime;
-    tiltSlider.onValueChange = updateRealtime;
-    ringSlider.onValueChange = updateRealtime;
-    shiftSlider.onValueChange = updateRealtime;
-    jitterSlider.onValueChange = updateRealtime;
-    mutationSlider.onValueChange = updateRealtime;
+    setupSlider (speedSlider, speedLabel, "Speed", "speed");
+    setupSlider (pitchSlider, pitchLabel, "Pitch", "pitch");
+    setupSlider (mouthSlider, mouthLabel, "Mouth", "mouth");
+    setupSlider (throatSlider, throatLabel, "Throat", "throat");
+    setupSlider (rtSpeedSlider, rtSpeedLabel, "Playback Speed", "rtSpeed");
+    setupSlider (rtPitchSlider, rtPitchLabel, "Repitch (st)", "rtPitchSemitones");
+    setupSlider (formantSlider, formantLabel, "Formant Warp", "rtFormant");
+    setupSlider (gateSlider, gateLabel, "Glitch Gate", "rtGate");
+    setupSlider (crushSlider, crushLabel, "Bit Crush", "rtCrush");
+    setupSlider (loopSlider, loopLabel, "Micro Loop", "rtLoop");
+    setupSlider (tiltSlider, tiltLabel, "Spectral Tilt", "rtTilt");
+    setupSlider (ringSlider, ringLabel, "Ring Mod", "rtRing");
+    setupSlider (shiftSlider, shiftLabel, "Freq Shift", "rtShift");
+    setupSlider (jitterSlider, jitterLabel, "Repitch Jitter", "rtJitter");
+    setupSlider (mutationSlider, mutationLabel, "Phoneme Mutation", "rtMutation");
+
+    shiftModeLabel.setText ("SHIFT MODE", juce::dontSendNotification);
+    shiftModeLabel.setFont (juce::FontOptions ("Verdana", 12.0f, juce::Font::bold));
+    shiftModeLabel.setColour (juce::Label::textColourId, juce::Colour::fromRGB (52, 46, 82));
+    addAndMakeVisible (shiftModeLabel);
+
+    shiftModeBox.addItemList ({ "Single Sideband", "Legacy Ring Blend" }, 1);
+    shiftModeBox.setColour (juce::ComboBox::backgroundColourId, juce::Colour::fromRGB (255, 248, 231));
+    shiftModeBox.setColour (juce::ComboBox::textColourId, juce::Colour::fromRGB (40, 36, 60));
+    shiftModeBox.setColour (juce::ComboBox::outlineColourId, juce::Colour::fromRGB (84, 78, 120));
+    shiftModeBox.setColour (juce::ComboBox::arrowColourId, juce::Colour::fromRGB (84, 78, 120));
+    addAndMakeVisible (shiftModeBox);
+    shiftModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (parameters, "rtShiftMode", shiftModeBox);
 
     auto styleToggle = [] (juce::ToggleButton& b)
     {
@@ -99,10 +98,11 @@ SAMVoiceSynthesizerAudioProcessorEditor::SAMVoiceSynthesizerAudioProcessorEditor
     addAndMakeVisible (backendModeButton);
     addAndMakeVisible (loopEndButton);
 
-    loopEndButton.onClick = [this]
-    {
-        samProcessor.setLoopAtEnd (loopEndButton.getToggleState());
-    };
+    // The backend is a two-way choice, so the toggle's on state is Better SAM.
+    buttonAttachments.push_back (std::make_unique<ButtonAttachment> (parameters, "singMode", singModeButton));
+    buttonAttachments.push_back (std::make_unique<ButtonAttachment> (parameters, "phoneticInput", phoneticModeButton));
+    buttonAttachments.push_back (std::make_unique<ButtonAttachment> (parameters, "backend", backendModeButton));
+    buttonAttachments.push_back (std::make_unique<ButtonAttachment> (parameters, "loopAtEnd", loopEndButton));
 
     nodePathLabel.setText ("NODE PATH", juce::dontSendNotification);
     nodePathLabel.setFont (juce::FontOptions ("Verdana", 12.0f, juce::Font::bold));
@@ -137,10 +137,7 @@ SAMVoiceSynthesizerAudioProcessorEditor::SAMVoiceSynthesizerAudioProcessorEditor
     textEditor.setTextToShowWhenEmpty ("TYPE OR FIRE UDP:7001", juce::Colour::fromRGB (160, 160, 160));
     textEditor.onReturnKey = [this]
     {
-        samProcessor.setParameters (gatherParams());
-        samProcessor.setRealtimeControls (gatherRealtimeControls());
         samProcessor.setNodePath (gatherNodePath());
-        samProcessor.setLoopAtEnd (loopEndButton.getToggleState());
         samProcessor.enqueueText (textEditor.getText());
     };
     addAndMakeVisible (textEditor);
@@ -168,13 +165,8 @@ SAMVoiceSynthesizerAudioProcessorEditor::SAMVoiceSynthesizerAudioProcessorEditor
     udpEditor.setFont (juce::FontOptions ("Verdana", 12.0f, juce::Font::plain));
     addAndMakeVisible (udpEditor);
 
-    applyParamsToUi (samProcessor.getParameters());
-    applyRealtimeControlsToUi (samProcessor.getRealtimeControls());
     applyNodePathToUi (samProcessor.getNodePath());
-    loopEndButton.setToggleState (samProcessor.getLoopAtEnd(), juce::dontSendNotification);
     presetBox.setSelectedItemIndex (samProcessor.getCurrentProgram(), juce::dontSendNotification);
-    samProcessor.setNodePath (gatherNodePath());
-    samProcessor.setRealtimeControls (gatherRealtimeControls());
     startTimerHz (12);
 }
 
@@ -281,6 +273,10 @@ void SAMVoiceSynthesizerAudioProcessorEditor::resized()
     placeFx (fxRight, ringLabel, ringSlider);
     placeFx (fxRight, jitterLabel, jitterSlider);
 
+    auto shiftModeRow = fxRight.removeFromTop (rowH);
+    shiftModeLabel.setBounds (shiftModeRow.removeFromLeft (124));
+    shiftModeBox.setBounds (shiftModeRow);
+
     rightContent.removeFromTop (blockGap);
     auto toggleRow = rightContent.removeFromTop (24);
     auto tA = toggleRow.removeFromLeft (toggleRow.getWidth() / 4);
@@ -307,55 +303,21 @@ void SAMVoiceSynthesizerAudioProcessorEditor::buttonClicked (juce::Button* butto
     if (button != &speakButton)
         return;
 
-    samProcessor.setParameters (gatherParams());
-    samProcessor.setRealtimeControls (gatherRealtimeControls());
     samProcessor.setNodePath (gatherNodePath());
-    samProcessor.setLoopAtEnd (loopEndButton.getToggleState());
     samProcessor.enqueueText (textEditor.getText());
 }
 
 void SAMVoiceSynthesizerAudioProcessorEditor::timerCallback()
 {
     presetBox.setSelectedItemIndex (samProcessor.getCurrentProgram(), juce::dontSendNotification);
+
     statusLabel.setText (
-        "Status: " + samProcessor.getUdpStatus() + " | " + samProcessor.getVoiceStatus(),
+        "Status: " + samProcessor.getUdpStatus() + " | " + samProcessor.getVoiceStatus() + " | " + samProcessor.getCacheStatus(),
         juce::dontSendNotification);
 
     udpEditor.setText (samProcessor.getUdpFeed(), juce::dontSendNotification);
 }
 
-SpeakNSpellVoice::Parameters SAMVoiceSynthesizerAudioProcessorEditor::gatherParams() const
-{
-    SpeakNSpellVoice::Parameters p;
-    p.speed = static_cast<int> (speedSlider.getValue());
-    p.pitch = static_cast<int> (pitchSlider.getValue());
-    p.mouth = static_cast<int> (mouthSlider.getValue());
-    p.throat = static_cast<int> (throatSlider.getValue());
-    p.singMode = singModeButton.getToggleState();
-    p.phoneticInput = phoneticModeButton.getToggleState();
-    p.backend = backendModeButton.getToggleState()
-        ? SpeakNSpellVoice::Parameters::Backend::betterSam
-        : SpeakNSpellVoice::Parameters::Backend::classicSam;
-    return p;
-}
-
-SpeakNSpellVoice::RealtimeControls SAMVoiceSynthesizerAudioProcessorEditor::gatherRealtimeControls() const
-{
-    SpeakNSpellVoice::RealtimeControls c;
-    c.playbackSpeed = static_cast<float> (rtSpeedSlider.getValue() / 100.0);
-    c.repitchSemitones = static_cast<float> (rtPitchSlider.getValue());
-    c.formantWarp = static_cast<float> (formantSlider.getValue() / 100.0);
-    c.glitchGate = static_cast<float> (gateSlider.getValue() / 100.0);
-    c.bitCrush = static_cast<float> (crushSlider.getValue() / 100.0);
-    c.microLoop = static_cast<float> (loopSlider.getValue() / 100.0);
-    c.spectralTilt = static_cast<float> (tiltSlider.getValue() / 100.0);
-    c.ringMod = static_cast<float> (ringSlider.getValue() / 100.0);
-    c.freqShift = static_cast<float> (shiftSlider.getValue() / 100.0);
-    c.repitchJitter = static_cast<float> (jitterSlider.getValue() / 100.0);
-    c.mutation = static_cast<float> (mutationSlider.getValue() / 100.0);
-    return c;
-}
-
 juce::String SAMVoiceSynthesizerAudioProcessorEditor::gatherNodePath() const
 {
     return nodePathEditor.getText().trim();
@@ -364,35 +326,6 @@ juce::String SAMVoiceSynthesizerAudioProcessorEditor::gatherNodePath() const
 void SAMVoiceSynthesizerAudioProcessorEditor::applyPreset (int presetIndex)
 {
     samProcessor.setCurrentProgram (presetIndex);
-    applyParamsToUi (samProcessor.getParameters());
-    applyRealtimeControlsToUi (samProcessor.getRealtimeControls());
-    loopEndButton.setToggleState (samProcessor.getLoopAtEnd(), juce::dontSendNotification);
-}
-
-void SAMVoiceSynthesizerAudioProcessorEditor::applyParamsToUi (const SpeakNSpellVoice::Parameters& p)
-{
-    speedSlider.setValue (p.speed, juce::dontSendNotification);
-    pitchSlider.setValue (p.pitch, juce::dontSendNotification);
-    mouthSlider.setValue (p.mouth, juce::dontSendNotification);
-    throatSlider.setValue (p.throat, juce::dontSendNotification);
-    singModeButton.setToggleState (p.singMode, juce::dontSendNotification);
-    phoneticModeButton.setToggleState (p.phoneticInput, juce::dontSendNotification);
-    backendModeButton.setToggleState (p.backend == SpeakNSpellVoice::Parameters::Backend::betterSam, juce::dontSendNotification);
-}
-
-void SAMVoiceSynthesizerAudioProcessorEditor::applyRealtimeControlsToUi (const SpeakNSpellVoice::RealtimeControls& controls)
-{
-    rtSpeedSlider.setValue (controls.playbackSpeed * 100.0f, juce::dontSendNotification);
-    rtPitchSlider.setValue (controls.repitchSemitones, juce::dontSendNotification);
-    formantSlider.setValue (controls.formantWarp * 100.0f, juce::dontSendNotification);
-    gateSlider.setValue (controls.glitchGate * 100.0f, juce::dontSendNotification);
-    crushSlider.setValue (controls.bitCrush * 100.0f, juce::dontSendNotification);
-    loopSlider.setValue (controls.microLoop * 100.0f, juce::dontSendNotification);
-    tiltSlider.setValue (controls.spectralTilt * 100.0f, juce::dontSendNotification);
-    ringSlider.setValue (controls.ringMod * 100.0f, juce::dontSendNotification);
-    shiftSlider.setValue (controls.freqShift * 100.0f, juce::dontSendNotification);
-    jitterSlider.setValue (controls.repitchJitter * 100.0f, juce::dontSendNotification);
-    mutationSlider.setValue (controls.mutation * 100.0f, juce::dontSendNotification);
 }
 
 void SAMVoiceSynthesizerAudioProcessorEditor::applyNodePathToUi (const juce::String& path)
@@ -18,14 +18,13 @@ private:
     void buttonClicked (juce::Button* button) override;
     void timerCallback() override;
 
-    SpeakNSpellVoice::Parameters gatherParams() const;
-    SpeakNSpellVoice::RealtimeControls gatherRealtimeControls() const;
     juce::String gatherNodePath() const;
     void applyPreset (int presetIndex);
-    void applyParamsToUi (const SpeakNSpellVoice::Parameters& p);
-    void applyRealtimeControlsToUi (const SpeakNSpellVoice::RealtimeControls& controls);
     void applyNodePathToUi (const juce::String& path);
 
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+
     SAMVoiceSynthesizerAudioProcessor& samProcessor;
 
     juce::Label titleLabel;
@@ -41,6 +40,8 @@ private:
     juce::Slider rtSpeedSlider, rtPitchSlider;
     juce::Label formantLabel, gateLabel, crushLabel, loopLabel, tiltLabel, ringLabel, shiftLabel, jitterLabel, mutationLabel;
     juce::Slider formantSlider, gateSlider, crushSlider, loopSlider, tiltSlider, ringSlider, shiftSlider, jitterSlider, mutationSlider;
+    juce::Label shiftModeLabel;
+    juce::ComboBox shiftModeBox;
     juce::ToggleButton singModeButton { "Sing Mode" };
     juce::ToggleButton phoneticModeButton { "Phonetic Input" };
     juce::ToggleButton backendModeButton { "Better SAM mode" };
@@ -51,5 +52,10 @@ private:
     juce::Label udpLabel;
     juce::TextEditor udpEditor;
 
+    // Declared after the controls so they are destroyed first.
+    std::vector<std::unique_ptr<SliderAttachment>> sliderAttachments;
+    std::vector<std::unique_ptr<ButtonAttachment>> buttonAttachments;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> shiftModeAttachment;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SAMVoiceSynthesizerAudioProcessorEditor)
 };
@@ -70,11 +70,94 @@ private:
     std::unique_ptr<juce::DatagramSocket> socket;
 };
 
+namespace
+{
+    // Render-time parameters: changing one re-renders the trigger text in the background.
+    const juce::StringArray renderParameterIds { "speed", "pitch", "mouth", "throat", "singMode", "phoneticInput", "backend", "rtMutation" };
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout SAMVoiceSynthesizerAudioProcessor::createParameterLayout()
+{
+    const SpeakNSpellVoice::Parameters p;
+    const SpeakNSpellVoice::RealtimeControls r;
+
+    // Amounts read as percentages, in the editor and in the host.
+    const auto percent = juce::AudioParameterFloatAttributes()
+                             .withStringFromValueFunction ([] (float v, int) { return juce::String (juce::roundToInt (v * 100.0f)) + " %"; })
+                             .withValueFromStringFunction ([] (const juce::String& text) { return text.getFloatValue() / 100.0f; });
+
+    auto unit = [percent] (const juce::String& id, const juce::String& name, float defaultValue)
+    {
+        return std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { id, 1 }, name, juce::NormalisableRange<float> (0.0f, 1.0f), defaultValue, percent);
+    };
+
+    juce::NormalisableRange<float> speedRange (0.25f, 4.0f);
+    speedRange.setSkewForCentre (1.0f);
+
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    layout.add (std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "speed", 1 }, "Speed", 1, 255, p.speed),
+                std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "pitch", 1 }, "Pitch", 0, 255, p.pitch),
+                std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "mouth", 1 }, "Mouth", 0, 255, p.mouth),
+                std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "throat", 1 }, "Throat", 0, 255, p.throat),
+                std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "singMode", 1 }, "Sing Mode", p.singMode),
+                std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "phoneticInput", 1 }, "Phonetic Input", p.phoneticInput),
+                std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "backend", 1 }, "Backend", juce::StringArray { "Classic SAM", "Better SAM" },
+                                                              static_cast<int> (p.backend)),
+                std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "loopAtEnd", 1 }, "Loop At End", false),
+                std::make_unique<juce::AudioParameterInt> (juce::ParameterID { "polyphony", 1 }, "Polyphony", 1, NoteVoicePool::maxVoices, 16),
+                std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "rtSpeed", 1 }, "Playback Speed", speedRange, r.playbackSpeed, percent),
+                std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "rtPitchSemitones", 1 }, "Repitch", juce::NormalisableRange<float> (-24.0f, 24.0f),
+                                                             r.repitchSemitones,
+                                                             juce::AudioParameterFloatAttributes().withStringFromValueFunction ([] (float v, int) { return juce::String (v, 1); })
+                                                                                                  .withLabel ("st")),
+                unit ("rtFormant", "Formant Warp", r.formantWarp),
+                unit ("rtGate", "Glitch Gate", r.glitchGate),
+                unit ("rtCrush", "Bit Crush", r.bitCrush),
+                unit ("rtLoop", "Micro Loop", r.microLoop),
+                unit ("rtTilt", "Spectral Tilt", r.spectralTilt),
+                unit ("rtRing", "Ring Mod", r.ringMod),
+                unit ("rtShift", "Freq Shift", r.freqShift),
+                std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "rtShiftMode", 1 }, "Freq Shift Mode",
+                                                              juce::StringArray { "Single Sideband", "Legacy Ring Blend" },
+                                                              static_cast<int> (SpeakNSpellVoice::FrequencyShiftMode::singleSideband)),
+                unit ("rtJitter", "Repitch Jitter", r.repitchJitter),
+                unit ("rtMutation", "Phoneme Mutation", r.mutation));
+    return layout;
+}
+
 SAMVoiceSynthesizerAudioProcessor::SAMVoiceSynthesizerAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
-    : juce::AudioProcessor (BusesProperties().withOutput ("Output", juce::AudioChannelSet::stereo(), true))
+    : juce::AudioProcessor (BusesProperties().withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
+#else
+    :
 #endif
+      parameterState (*this, nullptr, "SAMPluginParameters", createParameterLayout())
 {
+    raw.speed = parameterState.getRawParameterValue ("speed");
+    raw.pitch = parameterState.getRawParameterValue ("pitch");
+    raw.mouth = parameterState.getRawParameterValue ("mouth");
+    raw.throat = parameterState.getRawParameterValue ("throat");
+    raw.singMode = parameterState.getRawParameterValue ("singMode");
+    raw.phoneticInput = parameterState.getRawParameterValue ("phoneticInput");
+    raw.backend = parameterState.getRawParameterValue ("backend");
+    raw.loopAtEnd = parameterState.getRawParameterValue ("loopAtEnd");
+    raw.polyphony = parameterState.getRawParameterValue ("polyphony");
+    raw.playbackSpeed = parameterState.getRawParameterValue ("rtSpeed");
+    raw.repitchSemitones = parameterState.getRawParameterValue ("rtPitchSemitones");
+    raw.formantWarp = parameterState.getRawParameterValue ("rtFormant");
+    raw.glitchGate = parameterState.getRawParameterValue ("rtGate");
+    raw.bitCrush = parameterState.getRawParameterValue ("rtCrush");
+    raw.microLoop = parameterState.getRawParameterValue ("rtLoop");
+    raw.spectralTilt = parameterState.getRawParameterValue ("rtTilt");
+    raw.ringMod = parameterState.getRawParameterValue ("rtRing");
+    raw.freqShift = parameterState.getRawParameterValue ("rtShift");
+    raw.freqShiftMode = parameterState.getRawParameterValue ("rtShiftMode");
+    raw.repitchJitter = parameterState.getRawParameterValue ("rtJitter");
+    raw.mutation = parameterState.getRawParameterValue ("rtMutation");
+
+    for (const auto& id : renderParameterIds)
+        parameterState.addParameterListener (id, this);
+
     setCurrentProgram (0);
     setNodePath (juce::SystemStats::getEnvironmentVariable ("SAM_NODE_PATH", {}));
 
@@ -95,12 +178,16 @@ SAMVoiceSynthesizerAudioProcessor::SAMVoiceSynthesizerAudioProcessor()
 
 SAMVoiceSynthesizerAudioProcessor::~SAMVoiceSynthesizerAudioProcessor()
 {
+    for (const auto& id : renderParameterIds)
+        parameterState.removeParameterListener (id, this);
+
     udpReceiver.reset();
 }
 
 void SAMVoiceSynthesizerAudioProcessor::prepareToPlay (double sampleRate, int)
 {
     voice.setSampleRate (sampleRate);
+    voice.setNoteText (getTriggerText(), getParameters());
 }
 
 void SAMVoiceSynthesizerAudioProcessor::releaseResources()
@@ -118,20 +205,52 @@ void SAMVoiceSynthesizerAudioProcessor::processBlock (juce::AudioBuffer<float>&
     juce::ScopedNoDenormals noDenormals;
     buffer.clear();
 
+    voice.setLoopAtEnd (raw.loopAtEnd->load() >= 0.5f);
+    voice.setNumNoteVoices (static_cast<int> (raw.polyphony->load()));
+    voice.setFrequencyShiftMode (getFrequencyShiftMode());
+
+    // Renders up to each event and handles it there, so notes start on their own sample
+    // rather than at the next block boundary.
+    const auto numSamples = buffer.getNumSamples();
+    const auto controls = getRealtimeControls();
+    int rendered = 0;
+
     for (const auto metadata : midiMessages)
     {
-        const auto msg = metadata.getMessage();
-        if (msg.isNoteOn())
+        const auto position = juce::jlimit (rendered, numSamples, metadata.samplePosition);
+        if (position > rendered)
         {
-            const auto textToSpeak = triggerText.trim();
-            if (textToSpeak.isNotEmpty())
-                voice.queueText (textToSpeak, getParameters());
+            voice.render (buffer, rendered, position - rendered, controls);
+            rendered = position;
         }
+
+        handleMidiMessage (metadata.getMessage());
     }
 
-    voice.setRealtimeControls (getRealtimeControls());
-    voice.setLoopAtEnd (getLoopAtEnd());
-    voice.render (buffer, 0, buffer.getNumSamples());
+    if (rendered < numSamples)
+        voice.render (buffer, rendered, numSamples - rendered, controls);
+}
+
+void SAMVoiceSynthesizerAudioProcessor::handleMidiMessage (const juce::MidiMessage& msg)
+{
+    if (msg.isNoteOn())
+    {
+        // Until the trigger text has been rendered for notes, fall back to queueing it.
+        // That happens on the message thread, which is the only reader of the text.
+        if (! voice.noteOn (msg.getNoteNumber(), msg.getFloatVelocity()))
+        {
+            triggerTextWanted.store (true);
+            triggerAsyncUpdate();
+        }
+    }
+    else if (msg.isNoteOff())
+    {
+        voice.noteOff (msg.getNoteNumber());
+    }
+    else if (msg.isAllNotesOff() || msg.isAllSoundOff())
+    {
+        voice.allNotesOff();
+    }
 }
 
 juce::AudioProcessorEditor* SAMVoiceSynthesizerAudioProcessor::createEditor()
@@ -159,9 +278,9 @@ void SAMVoiceSynthesizerAudioProcessor::setCurrentProgram (int index)
     {
         const juce::ScopedLock sl (paramsLock);
         currentProgram = index;
-        parameters = p;
-        realtimeControls = r;
     }
+    setParameters (p);
+    setRealtimeControls (r);
 }
 
 const juce::String SAMVoiceSynthesizerAudioProcessor::getProgramName (int index)
@@ -171,29 +290,13 @@ const juce::String SAMVoiceSynthesizerAudioProcessor::getProgramName (int index)
 
 void SAMVoiceSynthesizerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto p = getParameters();
-    juce::ValueTree state ("SAMPluginState");
-    state.setProperty ("speed", p.speed, nullptr);
-    state.setProperty ("pitch", p.pitch, nullptr);
-    state.setProperty ("mouth", p.mouth, nullptr);
-    state.setProperty ("throat", p.throat, nullptr);
-    state.setProperty ("singMode", p.singMode, nullptr);
-    state.setProperty ("phoneticInput", p.phoneticInput, nullptr);
-    state.setProperty ("backend", static_cast<int> (p.backend), nullptr);
-    const auto rt = getRealtimeControls();
-    state.setProperty ("rtSpeed", rt.playbackSpeed, nullptr);
-    state.setProperty ("rtPitchSemitones", rt.repitchSemitones, nullptr);
-    state.setProperty ("rtFormant", rt.formantWarp, nullptr);
-    state.setProperty ("rtGate", rt.glitchGate, nullptr);
-    state.setProperty ("rtCrush", rt.bitCrush, nullptr);
-    state.setProperty ("rtLoop", rt.microLoop, nullptr);
-    state.setProperty ("rtTilt", rt.spectralTilt, nullptr);
-    state.setProperty ("rtRing", rt.ringMod, nullptr);
-    state.setProperty ("rtShift", rt.freqShift, nullptr);
-    state.setProperty ("rtJitter", rt.repitchJitter, nullptr);
-    state.setProperty ("rtMutation", rt.mutation, nullptr);
+    auto state = parameterState.copyState();
     state.setProperty ("nodePath", getNodePath(), nullptr);
-    state.setProperty ("loopAtEnd", getLoopAtEnd(), nullptr);
+    state.setProperty ("resampleQuality", static_cast<int> (getResampleQuality()), nullptr);
+    const auto limits = getQueueLimits();
+    state.setProperty ("queueMaxSeconds", limits.maxQueuedSeconds, nullptr);
+    state.setProperty ("queueMaxJobs", limits.maxPendingJobs, nullptr);
+    state.setProperty ("queuePolicy", static_cast<int> (limits.policy), nullptr);
     state.setProperty ("currentProgram", getCurrentProgram(), nullptr);
 
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
@@ -210,6 +313,34 @@ void SAMVoiceSynthesizerAudioProcessor::setStateInformation (const void* data, i
     if (! state.isValid())
         return;
 
+    if (state.hasType (parameterState.state.getType()))
+        parameterState.replaceState (state);
+    else
+        loadLegacyState (state);
+
+    setNodePath (state.getProperty ("nodePath", getNodePath()).toString());
+    setResampleQuality (static_cast<PolyphaseResampler::Quality> (juce::jlimit (0, 2, static_cast<int> (state.getProperty ("resampleQuality", static_cast<int> (PolyphaseResampler::Quality::standard))))));
+    // Sessions saved before the mode was a parameter kept it as a property, and ones saved
+    // before the single-sideband shifter have neither and keep the ring-blend sound.
+    if (! state.getChildWithProperty ("id", "rtShiftMode").isValid())
+        setFrequencyShiftMode (static_cast<SpeakNSpellVoice::FrequencyShiftMode> (juce::jlimit (0, 1, static_cast<int> (state.getProperty ("frequencyShiftMode", static_cast<int> (SpeakNSpellVoice::FrequencyShiftMode::legacyRingBlend))))));
+
+    SpeakNSpellVoice::QueueLimits limits;
+    limits.maxQueuedSeconds = static_cast<double> (state.getProperty ("queueMaxSeconds", limits.maxQueuedSeconds));
+    limits.maxPendingJobs = static_cast<int> (state.getProperty ("queueMaxJobs", limits.maxPendingJobs));
+    limits.policy = static_cast<SpeakNSpellVoice::QueuePolicy> (juce::jlimit (0, 3, static_cast<int> (state.getProperty ("queuePolicy", static_cast<int> (limits.policy)))));
+    setQueueLimits (limits);
+    if (state.hasProperty ("currentProgram"))
+    {
+        const juce::ScopedLock sl (paramsLock);
+        currentProgram = juce::jlimit (0, getNumPrograms() - 1, static_cast<int> (state.getProperty ("currentProgram", 0)));
+    }
+}
+
+// Sessions saved before the parameters were automatable kept every value as a property
+// of a "SAMPluginState" tree, under the names the parameters now use as IDs.
+void SAMVoiceSynthesizerAudioProcessor::loadLegacyState (const juce::ValueTree& state)
+{
     SpeakNSpellVoice::Parameters p;
     p.speed = static_cast<int> (state.getProperty ("speed", p.speed));
     p.pitch = static_cast<int> (state.getProperty ("pitch", p.pitch));
@@ -234,46 +365,83 @@ void SAMVoiceSynthesizerAudioProcessor::setStateInformation (const void* data, i
     rt.mutation = static_cast<float> (state.getProperty ("rtMutation", rt.mutation));
     setRealtimeControls (rt);
     setLoopAtEnd (static_cast<bool> (state.getProperty ("loopAtEnd", false)));
-    if (state.hasProperty ("currentProgram"))
-    {
-        const auto programIndex = static_cast<int> (state.getProperty ("currentProgram", 0));
-        {
-            const juce::ScopedLock sl (paramsLock);
-            currentProgram = juce::jlimit (0, getNumPrograms() - 1, programIndex);
-        }
-    }
-    if (state.hasProperty ("nodePath"))
-        setNodePath (state.getProperty ("nodePath").toString());
 }
 
 void SAMVoiceSynthesizerAudioProcessor::enqueueText (const juce::String& text)
 {
-    triggerText = text;
+    {
+        const juce::ScopedLock sl (triggerTextLock);
+        triggerText = text;
+    }
+
     voice.queueText (text, getParameters());
+    voice.setNoteText (text, getParameters());
+}
+
+void SAMVoiceSynthesizerAudioProcessor::setParameterValue (const juce::String& parameterId, float value)
+{
+    if (auto* parameter = parameterState.getParameter (parameterId))
+    {
+        const auto normalised = parameter->convertTo0to1 (value);
+        if (std::abs (parameter->getValue() - normalised) > 1.0e-6f)
+            parameter->setValueNotifyingHost (normalised);
+    }
 }
 
 void SAMVoiceSynthesizerAudioProcessor::setParameters (const SpeakNSpellVoice::Parameters& newParams)
 {
-    const juce::ScopedLock sl (paramsLock);
-    parameters = newParams;
+    setParameterValue ("speed", static_cast<float> (newParams.speed));
+    setParameterValue ("pitch", static_cast<float> (newParams.pitch));
+    setParameterValue ("mouth", static_cast<float> (newParams.mouth));
+    setParameterValue ("throat", static_cast<float> (newParams.throat));
+    setParameterValue ("singMode", newParams.singMode ? 1.0f : 0.0f);
+    setParameterValue ("phoneticInput", newParams.phoneticInput ? 1.0f : 0.0f);
+    setParameterValue ("backend", static_cast<float> (newParams.backend));
 }
 
 SpeakNSpellVoice::Parameters SAMVoiceSynthesizerAudioProcessor::getParameters() const
 {
-    const juce::ScopedLock sl (paramsLock);
-    return parameters;
+    SpeakNSpellVoice::Parameters p;
+    p.speed = juce::roundToInt (raw.speed->load());
+    p.pitch = juce::roundToInt (raw.pitch->load());
+    p.mouth = juce::roundToInt (raw.mouth->load());
+    p.throat = juce::roundToInt (raw.throat->load());
+    p.singMode = raw.singMode->load() >= 0.5f;
+    p.phoneticInput = raw.phoneticInput->load() >= 0.5f;
+    p.backend = static_cast<SpeakNSpellVoice::Parameters::Backend> (juce::roundToInt (raw.backend->load()));
+    return p;
 }
 
 void SAMVoiceSynthesizerAudioProcessor::setRealtimeControls (const SpeakNSpellVoice::RealtimeControls& controls)
 {
-    const juce::ScopedLock sl (paramsLock);
-    realtimeControls = controls;
+    setParameterValue ("rtSpeed", controls.playbackSpeed);
+    setParameterValue ("rtPitchSemitones", controls.repitchSemitones);
+    setParameterValue ("rtFormant", controls.formantWarp);
+    setParameterValue ("rtGate", controls.glitchGate);
+    setParameterValue ("rtCrush", controls.bitCrush);
+    setParameterValue ("rtLoop", controls.microLoop);
+    setParameterValue ("rtTilt", controls.spectralTilt);
+    setParameterValue ("rtRing", controls.ringMod);
+    setParameterValue ("rtShift", controls.freqShift);
+    setParameterValue ("rtJitter", controls.repitchJitter);
+    setParameterValue ("rtMutation", controls.mutation);
 }
 
 SpeakNSpellVoice::RealtimeControls SAMVoiceSynthesizerAudioProcessor::getRealtimeControls() const
 {
-    const juce::ScopedLock sl (paramsLock);
-    return realtimeControls;
+    SpeakNSpellVoice::RealtimeControls c;
+    c.playbackSpeed = raw.playbackSpeed->load();
+    c.repitchSemitones = raw.repitchSemitones->load();
+    c.formantWarp = raw.formantWarp->load();
+    c.glitchGate = raw.glitchGate->load();
+    c.bitCrush = raw.bitCrush->load();
+    c.microLoop = raw.microLoop->load();
+    c.spectralTilt = raw.spectralTilt->load();
+    c.ringMod = raw.ringMod->load();
+    c.freqShift = raw.freqShift->load();
+    c.repitchJitter = raw.repitchJitter->load();
+    c.mutation = raw.mutation->load();
+    return c;
 }
 
 void SAMVoiceSynthesizerAudioProcessor::setNodePath (const juce::String& path)
@@ -294,17 +462,71 @@ juce::String SAMVoiceSynthesizerAudioProcessor::getNodePath() const
 
 void SAMVoiceSynthesizerAudioProcessor::setLoopAtEnd (bool shouldLoop)
 {
-    {
-        const juce::ScopedLock sl (paramsLock);
-        loopAtEnd = shouldLoop;
-    }
-    voice.setLoopAtEnd (shouldLoop);
+    setParameterValue ("loopAtEnd", shouldLoop ? 1.0f : 0.0f);
 }
 
 bool SAMVoiceSynthesizerAudioProcessor::getLoopAtEnd() const
 {
-    const juce::ScopedLock sl (paramsLock);
-    return loopAtEnd;
+    return raw.loopAtEnd->load() >= 0.5f;
+}
+
+juce::String SAMVoiceSynthesizerAudioProcessor::getTriggerText() const
+{
+    const juce::ScopedLock sl (triggerTextLock);
+    return triggerText;
+}
+
+// May arrive on the audio thread during automation, so only flag the change here.
+void SAMVoiceSynthesizerAudioProcessor::parameterChanged (const juce::String&, float)
+{
+    renderParametersChanged.store (true);
+    triggerAsyncUpdate();
+}
+
+// Waits for the values to settle so a knob sweep renders once, not at every step.
+void SAMVoiceSynthesizerAudioProcessor::handleAsyncUpdate()
+{
+    if (triggerTextWanted.exchange (false))
+        voice.queueText (getTriggerText(), getParameters());
+
+    if (renderParametersChanged.exchange (false))
+        startTimer (250);
+}
+
+void SAMVoiceSynthesizerAudioProcessor::timerCallback()
+{
+    stopTimer();
+    voice.setNoteText (getTriggerText(), getParameters());
+}
+
+void SAMVoiceSynthesizerAudioProcessor::setResampleQuality (PolyphaseResampler::Quality quality)
+{
+    voice.setResampleQuality (quality);
+}
+
+PolyphaseResampler::Quality SAMVoiceSynthesizerAudioProcessor::getResampleQuality() const
+{
+    return voice.getResampleQuality();
+}
+
+void SAMVoiceSynthesizerAudioProcessor::setFrequencyShiftMode (SpeakNSpellVoice::FrequencyShiftMode mode)
+{
+    setParameterValue ("rtShiftMode", static_cast<float> (mode));
+}
+
+SpeakNSpellVoice::FrequencyShiftMode SAMVoiceSynthesizerAudioProcessor::getFrequencyShiftMode() const
+{
+    return static_cast<SpeakNSpellVoice::FrequencyShiftMode> (juce::roundToInt (raw.freqShiftMode->load()));
+}
+
+void SAMVoiceSynthesizerAudioProcessor::setQueueLimits (const SpeakNSpellVoice::QueueLimits& limits)
+{
+    voice.setQueueLimits (limits);
+}
+
+SpeakNSpellVoice::QueueLimits SAMVoiceSynthesizerAudioProcessor::getQueueLimits() const
+{
+    return voice.getQueueLimits();
 }
 
 juce::String SAMVoiceSynthesizerAudioProcessor::getVoiceStatus() const
@@ -312,10 +534,23 @@ juce::String SAMVoiceSynthesizerAudioProcessor::getVoiceStatus() const
     return voice.getStatusText();
 }
 
+juce::String SAMVoiceSynthesizerAudioProcessor::getCacheStatus() const
+{
+    return voice.getCacheStatusText();
+}
+
 juce::String SAMVoiceSynthesizerAudioProcessor::getUdpStatus() const
 {
-    const juce::ScopedLock sl (udpStatusLock);
-    return udpStatus;
+    juce::String text;
+    {
+        const juce::ScopedLock sl (udpStatusLock);
+        text = udpStatus;
+    }
+
+    const auto queue = voice.getQueueStatusText();
+    if (queue.isNotEmpty())
+        text << " | " << queue;
+    return text;
 }
 
 juce::String SAMVoiceSynthesizerAudioProcessor::getUdpFeed() const
@@ -3,7 +3,10 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "SpeakNSpellVoice.h"
 
-class SAMVoiceSynthesizerAudioProcessor final : public juce::AudioProcessor
+class SAMVoiceSynthesizerAudioProcessor final : public juce::AudioProcessor,
+                                                 private juce::AudioProcessorValueTreeState::Listener,
+                                                 private juce::AsyncUpdater,
+                                                 private juce::Timer
 {
 public:
     SAMVoiceSynthesizerAudioProcessor();
@@ -43,24 +46,75 @@ public:
     juce::String getNodePath() const;
     void setLoopAtEnd (bool shouldLoop);
     bool getLoopAtEnd() const;
+    void setResampleQuality (PolyphaseResampler::Quality quality);
+    PolyphaseResampler::Quality getResampleQuality() const;
+    void setFrequencyShiftMode (SpeakNSpellVoice::FrequencyShiftMode mode);
+    SpeakNSpellVoice::FrequencyShiftMode getFrequencyShiftMode() const;
+    void setQueueLimits (const SpeakNSpellVoice::QueueLimits& limits);
+    SpeakNSpellVoice::QueueLimits getQueueLimits() const;
 
     juce::String getVoiceStatus() const;
+    juce::String getCacheStatus() const;
     juce::String getUdpStatus() const;
     juce::String getUdpFeed() const;
 
+    juce::AudioProcessorValueTreeState& getParameterState() { return parameterState; }
+
 private:
     class UdpTextReceiver;
 
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    void setParameterValue (const juce::String& parameterId, float value);
+    void loadLegacyState (const juce::ValueTree& state);
+
+    void parameterChanged (const juce::String& parameterId, float newValue) override;
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+
+    void handleMidiMessage (const juce::MidiMessage& msg);
     void appendUdpLine (const juce::String& text);
+    juce::String getTriggerText() const;
 
     SpeakNSpellVoice voice;
+
+    // Set from the UDP and message threads; the audio thread never touches the string.
+    mutable juce::CriticalSection triggerTextLock;
     juce::String triggerText { "Hello! This is a SAM-style voice synthesizer." };
+    std::atomic<bool> triggerTextWanted { false };
+    std::atomic<bool> renderParametersChanged { false };
+
+    juce::AudioProcessorValueTreeState parameterState;
+
+    // Read with plain atomic loads on any thread, including the audio thread.
+    struct RawParameterValues
+    {
+        std::atomic<float>* speed = nullptr;
+        std::atomic<float>* pitch = nullptr;
+        std::atomic<float>* mouth = nullptr;
+        std::atomic<float>* throat = nullptr;
+        std::atomic<float>* singMode = nullptr;
+        std::atomic<float>* phoneticInput = nullptr;
+        std::atomic<float>* backend = nullptr;
+        std::atomic<float>* loopAtEnd = nullptr;
+        std::atomic<float>* polyphony = nullptr;
+        std::atomic<float>* playbackSpeed = nullptr;
+        std::atomic<float>* repitchSemitones = nullptr;
+        std::atomic<float>* formantWarp = nullptr;
+        std::atomic<float>* glitchGate = nullptr;
+        std::atomic<float>* bitCrush = nullptr;
+        std::atomic<float>* microLoop = nullptr;
+        std::atomic<float>* spectralTilt = nullptr;
+        std::atomic<float>* ringMod = nullptr;
+        std::atomic<float>* freqShift = nullptr;
+        std::atomic<float>* freqShiftMode = nullptr;
+        std::atomic<float>* repitchJitter = nullptr;
+        std::atomic<float>* mutation = nullptr;
+    };
+
+    RawParameterValues raw;
 
     mutable juce::CriticalSection paramsLock;
-    SpeakNSpellVoice::Parameters parameters;
-    SpeakNSpellVoice::RealtimeControls realtimeControls;
     juce::String nodePath;
-    bool loopAtEnd = false;
     int currentProgram = 0;
 
     mutable juce::CriticalSection udpStatusLock;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// Kaiser-windowed sinc kernels for band-limited playback of rendered phrases. Each
+// kernel has maxPhases rows, so Pcm8Interpolator can read it at any fractional source
+// position. Kernels are built once per (rates, quality) and shared between instances.
+class PolyphaseResampler
+{
+public:
+    enum class Quality
+    {
+        linear,     // the original two-point interpolation, no anti-imaging filter
+        standard,   // 16 taps per phase
+        high        // 48 taps per phase
+    };
+
+private:
+    friend class Pcm8Interpolator;
+
+    struct Kernel
+    {
+        int numPhases = 1;
+        int numTaps = 0;
+        std::vector<float> coeffs; // numPhases rows of numTaps, oldest input first
+    };
+
+    static constexpr int maxPhases = 1024;
+
+    static double besselI0 (double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static std::shared_ptr<const Kernel> buildKernel (double sourceRate, double targetRate, Quality quality)
+    {
+        auto k = std::make_shared<Kernel>();
+        k->numPhases = maxPhases;
+
+        // Cut off just below the lower of the two Nyquist frequencies; when decimating the
+        // kernel widens so the transition band stays the same in output terms.
+        const auto rolloff = quality == Quality::high ? 0.94 : 0.90;
+        const auto cutoff = rolloff * std::min (1.0, targetRate / sourceRate);
+        const auto baseTaps = quality == Quality::high ? 48 : 16;
+        k->numTaps = ((static_cast<int> (std::ceil (baseTaps / std::min (1.0, targetRate / sourceRate))) + 7) / 8) * 8;
+
+        const auto beta = quality == Quality::high ? 9.0 : 6.0;
+        const auto halfWidth = 0.5 * k->numTaps;
+        const auto lookahead = k->numTaps / 2;
+
+        k->coeffs.resize (static_cast<size_t> (k->numPhases) * static_cast<size_t> (k->numTaps));
+        for (int phase = 0; phase < k->numPhases; ++phase)
+        {
+            auto* row = k->coeffs.data() + static_cast<size_t> (phase) * static_cast<size_t> (k->numTaps);
+            double sum = 0.0;
+
+            for (int m = 0; m < k->numTaps; ++m)
+            {
+                // Distance from this input sample to the output instant, in input samples.
+                const auto d = static_cast<double> (phase) / k->numPhases - lookahead + (k->numTaps - 1 - m);
+                const auto x = cutoff * d;
+                const auto sinc = std::abs (x) < 1.0e-12 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                const auto w = d / halfWidth;
+                const auto window = std::abs (w) <= 1.0 ? besselI0 (beta * std::sqrt (1.0 - w * w)) / besselI0 (beta) : 0.0;
+                row[m] = static_cast<float> (cutoff * sinc * window);
+                sum += row[m];
+            }
+
+            // Unity gain at DC for every phase, so steady levels don't ripple.
+            if (std::abs (sum) > 1.0e-9)
+                for (int m = 0; m < k->numTaps; ++m)
+                    row[m] = static_cast<float> (row[m] / sum);
+        }
+
+        return k;
+    }
+
+    static std::shared_ptr<const Kernel> getKernel (double sourceRate, double targetRate, Quality quality)
+    {
+        static juce::CriticalSection lock;
+        static std::map<std::tuple<double, double, int>, std::shared_ptr<const Kernel>> kernels;
+
+        const auto key = std::make_tuple (sourceRate, targetRate, static_cast<int> (quality));
+        const juce::ScopedLock sl (lock);
+        auto& entry = kernels[key];
+        if (entry == nullptr)
+            entry = buildKernel (sourceRate, targetRate, quality);
+        return entry;
+    }
+};
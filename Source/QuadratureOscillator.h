@@ -0,0 +1,99 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cmath>
+#include "EffectKernels.h"
+
+// Sine and cosine carriers for the voice's modulators, produced a block at a time.
+// Four float phasors, one per lane and a sample apart, are rotated by four samples'
+// worth of angle per step. They are re-seeded from an exact double phase every
+// chunkSize samples, so rounding never accumulates past one chunk and the phase
+// follows the same accumulator the per-sample std::sin calls used.
+class QuadratureOscillator
+{
+public:
+    static constexpr int chunkSize = 64;
+
+    void reset (double newPhase = 0.0)
+    {
+        phase = std::fmod (newPhase, juce::MathConstants<double>::twoPi);
+    }
+
+    void setIncrement (double radiansPerSample)
+    {
+        if (radiansPerSample == increment)
+            return;
+
+        increment = radiansPerSample;
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            laneCos[lane] = std::cos (increment * (lane + 1));
+            laneSin[lane] = std::sin (increment * (lane + 1));
+        }
+
+        stepCos = static_cast<float> (std::cos (4.0 * increment));
+        stepSin = static_cast<float> (std::sin (4.0 * increment));
+    }
+
+    double getPhase() const { return phase; }
+
+    // Writes sin and cos of the phase after each of the next numSamples steps; the phase
+    // advances before every sample. Either output may be null.
+    void process (float* sinOut, float* cosOut, int numSamples)
+    {
+        using namespace EffectKernels;
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const auto count = juce::jmin (chunkSize, numSamples - start);
+            const auto baseCos = std::cos (phase);
+            const auto baseSin = std::sin (phase);
+
+            float seedCos[4], seedSin[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                seedCos[lane] = static_cast<float> (baseCos * laneCos[lane] - baseSin * laneSin[lane]);
+                seedSin[lane] = static_cast<float> (baseSin * laneCos[lane] + baseCos * laneSin[lane]);
+            }
+
+            auto c = load (seedCos);
+            auto s = load (seedSin);
+            const auto rc = splat (stepCos);
+            const auto rs = splat (stepSin);
+
+            for (int i = 0; i < count; i += 4)
+            {
+                if (i + 4 <= count)
+                {
+                    if (sinOut != nullptr) store (sinOut + start + i, s);
+                    if (cosOut != nullptr) store (cosOut + start + i, c);
+                }
+                else
+                {
+                    float sinTail[4], cosTail[4];
+                    store (sinTail, s);
+                    store (cosTail, c);
+                    for (int j = 0; j < count - i; ++j)
+                    {
+                        if (sinOut != nullptr) sinOut[start + i + j] = sinTail[j];
+                        if (cosOut != nullptr) cosOut[start + i + j] = cosTail[j];
+                    }
+                }
+
+                const auto nextCos = sub (mul (c, rc), mul (s, rs));
+                s = add (mul (s, rc), mul (c, rs));
+                c = nextCos;
+            }
+
+            phase = std::fmod (phase + increment * count, juce::MathConstants<double>::twoPi);
+        }
+    }
+
+private:
+    double phase = 0.0;
+    double increment = 0.0;
+    double laneCos[4] { 1.0, 1.0, 1.0, 1.0 };
+    double laneSin[4] {};
+    float stepCos = 1.0f;
+    float stepSin = 0.0f;
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Byte-budgeted LRU cache of rendered phrases, kept as SAM's native 8-bit PCM. Entries
+// are immutable and shared, so a hit hands out the buffer without copying it under the
+// lock.
+class RenderCache
+{
+public:
+    using Samples = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t bytes = 0;
+        size_t entries = 0;
+    };
+
+    explicit RenderCache (size_t budgetBytesIn = 64 * 1024 * 1024)
+        : budgetBytes (budgetBytesIn)
+    {
+        spareNodes.reserve (maxSpareNodes);
+    }
+
+    Samples find (const std::string& key)
+    {
+        const juce::ScopedLock sl (lock);
+
+        const auto it = index.find (key);
+        if (it == index.end())
+        {
+            ++stats.misses;
+            return {};
+        }
+
+        entries.splice (entries.begin(), entries, it->second);
+        ++stats.hits;
+        return it->second->samples;
+    }
+
+    void insert (const std::string& key, Samples samples)
+    {
+        if (samples == nullptr)
+            return;
+
+        const auto bytes = entryBytes (key, *samples);
+        const juce::ScopedLock sl (lock);
+
+        if (const auto it = index.find (key); it != index.end())
+            erase (it->second);
+
+        if (bytes > budgetBytes)
+            return;
+
+        if (spareEntries.empty())
+        {
+            entries.push_front ({ key, std::move (samples), bytes });
+        }
+        else
+        {
+            entries.splice (entries.begin(), spareEntries, spareEntries.begin());
+            entries.front().key = key;
+            entries.front().samples = std::move (samples);
+            entries.front().bytes = bytes;
+        }
+
+        if (spareNodes.empty())
+        {
+            index.emplace (key, entries.begin());
+        }
+        else
+        {
+            auto node = std::move (spareNodes.back());
+            spareNodes.pop_back();
+            node.key() = key;
+            node.mapped() = entries.begin();
+            index.insert (std::move (node));
+        }
+
+        stats.bytes += bytes;
+        trimToBudget();
+    }
+
+    void clear()
+    {
+        const juce::ScopedLock sl (lock);
+        entries.clear();
+        index.clear();
+        spareEntries.clear();
+        spareNodes.clear();
+        stats.bytes = 0;
+    }
+
+    void setBudgetBytes (size_t newBudgetBytes)
+    {
+        const juce::ScopedLock sl (lock);
+        budgetBytes = newBudgetBytes;
+        trimToBudget();
+    }
+
+    size_t getBudgetBytes() const
+    {
+        const juce::ScopedLock sl (lock);
+        return budgetBytes;
+    }
+
+    Stats getStats() const
+    {
+        const juce::ScopedLock sl (lock);
+        auto s = stats;
+        s.entries = entries.size();
+        return s;
+    }
+
+private:
+    static constexpr size_t maxSpareNodes = 64;
+
+    struct Entry
+    {
+        std::string key;
+        Samples samples;
+        size_t bytes = 0;
+    };
+
+    using Index = std::unordered_map<std::string, std::list<Entry>::iterator>;
+
+    static size_t entryBytes (const std::string& key, const std::vector<uint8_t>& samples)
+    {
+        return sizeof (Entry) + key.size() + samples.capacity();
+    }
+
+    // Evicted list and index nodes are kept for the next insert, keys and all, so a cache
+    // that churns at a steady size stops allocating.
+    void erase (std::list<Entry>::iterator it)
+    {
+        stats.bytes -= it->bytes;
+        auto node = index.extract (it->key);
+        it->samples.reset();
+
+        if (spareNodes.size() >= maxSpareNodes)
+        {
+            entries.erase (it);
+            return;
+        }
+
+        spareNodes.push_back (std::move (node));
+        spareEntries.splice (spareEntries.end(), entries, it);
+    }
+
+    void trimToBudget()
+    {
+        while (stats.bytes > budgetBytes && ! entries.empty())
+        {
+            erase (std::prev (entries.end()));
+            ++stats.evictions;
+        }
+    }
+
+    juce::CriticalSection lock;
+    std::list<Entry> entries;
+    Index index;
+    std::list<Entry> spareEntries;
+    std::vector<Index::node_type> spareNodes;
+    size_t budgetBytes;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderCache)
+};
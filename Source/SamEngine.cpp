@@ -0,0 +1,1753 @@
+#include "SamEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    const int charFlags[] =
+    {
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 2, 2, 2, 2, 2, 2, 130, 0, 0, 2, 2, 2, 2, 2, 2,
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2,
+        2, 192, 168, 176, 172, 192, 160, 184, 160, 192, 188, 160, 172, 168, 172, 192,
+        160, 160, 172, 180, 164, 192, 168, 168, 176, 192, 188, 0, 0, 0, 2, 0,
+        32, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+    };
+
+    const char* const phonemeNames[] =
+    {
+        " *", ".*", "?*", ",*", "-*", "IY", "IH", "EH", "AE", "AA", "AH", "AO", "UH", "AX", "IX", "ER",
+        "UX", "OH", "RX", "LX", "WX", "YX", "WH", "R*", "L*", "W*", "Y*", "M*", "N*", "NX", "DX", "Q*",
+        "S*", "SH", "F*", "TH", "/H", "/X", "Z*", "ZH", "V*", "DH", "CH", "**", "J*", "**", "**", "**",
+        "EY", "AY", "OY", "AW", "OW", "UW", "B*", "**", "**", "D*", "**", "**", "G*", "**", "**", "GX",
+        "**", "**", "P*", "**", "**", "T*", "**", "**", "K*", "**", "**", "KX", "**", "**", "UL", "UM",
+        "UN"
+    };
+
+    const int phonemeFlags[] =
+    {
+        0x8000, 0xC100, 0xC100, 0xC100, 0xC100, 0x00A4, 0x00A4, 0x00A4,
+        0x00A4, 0x00A4, 0x00A4, 0x0084, 0x0084, 0x00A4, 0x00A4, 0x0084,
+        0x0084, 0x0084, 0x0084, 0x0084, 0x0084, 0x0084, 0x0044, 0x1044,
+        0x1044, 0x1044, 0x1044, 0x084C, 0x0C4C, 0x084C, 0x0448, 0x404C,
+        0x2440, 0x2040, 0x2040, 0x2440, 0x0040, 0x0040, 0x2444, 0x2044,
+        0x2044, 0x2444, 0x2048, 0x2040, 0x004C, 0x2044, 0x0000, 0x0000,
+        0x00B4, 0x00B4, 0x00B4, 0x0094, 0x0094, 0x0094, 0x004E, 0x004E,
+        0x004E, 0x044E, 0x044E, 0x044E, 0x004E, 0x004E, 0x004E, 0x004E,
+        0x004E, 0x004E, 0x004B, 0x004B, 0x004B, 0x044B, 0x044B, 0x044B,
+        0x004B, 0x004B, 0x004B, 0x004B, 0x004B, 0x004B, 0x0080, 0x00C1,
+        0x00C1
+    };
+
+    const int phonemeLengths[] =
+    {
+        0x0000, 0x1212, 0x1212, 0x1212, 0x0808, 0x0B08, 0x0908, 0x0B08,
+        0x0E08, 0x0F0B, 0x0B06, 0x100C, 0x0C0A, 0x0605, 0x0605, 0x0E0B,
+        0x0C0A, 0x0E0A, 0x0C0A, 0x0B09, 0x0808, 0x0807, 0x0B09, 0x0A07,
+        0x0906, 0x0808, 0x0806, 0x0807, 0x0807, 0x0807, 0x0302, 0x0505,
+        0x0202, 0x0202, 0x0202, 0x0202, 0x0202, 0x0202, 0x0606, 0x0606,
+        0x0807, 0x0606, 0x0606, 0x0202, 0x0908, 0x0403, 0x0201, 0x011E,
+        0x0E0D, 0x0F0C, 0x0F0C, 0x0F0C, 0x0E0E, 0x0E09, 0x0806, 0x0201,
+        0x0202, 0x0705, 0x0201, 0x0101, 0x0706, 0x0201, 0x0202, 0x0706,
+        0x0201, 0x0202, 0x0808, 0x0202, 0x0202, 0x0604, 0x0202, 0x0202,
+        0x0706, 0x0201, 0x0404, 0x0706, 0x0101, 0x0404, 0x05C7, 0x05FF
+    };
+
+    const int blendRank[] =
+    {
+        0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x05, 0x05,
+        0x02, 0x0A, 0x02, 0x08, 0x05, 0x05, 0x0B, 0x0A, 0x09, 0x08, 0x08, 0xA0, 0x08, 0x08, 0x17, 0x1F,
+        0x12, 0x12, 0x12, 0x12, 0x1E, 0x1E, 0x14, 0x14, 0x14, 0x14, 0x17, 0x17, 0x1A, 0x1A, 0x1D, 0x1D,
+        0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x1A, 0x1D, 0x1B, 0x1A, 0x1D, 0x1B, 0x1A, 0x1D, 0x1B, 0x1A,
+        0x1D, 0x1B, 0x17, 0x1D, 0x17, 0x17, 0x1D, 0x17, 0x17, 0x1D, 0x17, 0x17, 0x1D, 0x17, 0x17, 0x17
+    };
+
+    const int outBlendLength[] =
+    {
+        0x00, 0x02, 0x02, 0x02, 0x02, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+        0x04, 0x04, 0x03, 0x02, 0x04, 0x04, 0x02, 0x02, 0x02, 0x02, 0x02, 0x01, 0x01, 0x01, 0x01, 0x01,
+        0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x05,
+        0x05, 0x05, 0x05, 0x05, 0x04, 0x04, 0x02, 0x00, 0x01, 0x02, 0x00, 0x01, 0x02, 0x00, 0x01, 0x02,
+        0x00, 0x01, 0x02, 0x00, 0x02, 0x02, 0x00, 0x01, 0x03, 0x00, 0x02, 0x03, 0x00, 0x02, 0xA0, 0xA0
+    };
+
+    const int inBlendLength[] =
+    {
+        0x00, 0x02, 0x02, 0x02, 0x02, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+        0x04, 0x04, 0x03, 0x03, 0x04, 0x04, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x02, 0x03, 0x02, 0x01,
+        0x03, 0x03, 0x03, 0x03, 0x01, 0x01, 0x03, 0x03, 0x03, 0x02, 0x02, 0x03, 0x02, 0x03, 0x00, 0x00,
+        0x05, 0x05, 0x05, 0x05, 0x04, 0x04, 0x02, 0x00, 0x02, 0x02, 0x00, 0x03, 0x02, 0x00, 0x04, 0x02,
+        0x00, 0x03, 0x02, 0x00, 0x02, 0x02, 0x00, 0x02, 0x03, 0x00, 0x03, 0x03, 0x00, 0x03, 0xB0, 0xA0
+    };
+
+    const int sampledConsonantFlags[] =
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xF1, 0xE2, 0xD3, 0xBB, 0x7C, 0x95, 0x01, 0x02, 0x03, 0x03, 0x00, 0x72, 0x00, 0x02, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    const int classicFrequencyData[] =
+    {
+        0x000000, 0x5B4313, 0x5B4313, 0x5B4313, 0x5B4313, 0x6E540A, 0x5D490E, 0x5B4313,
+        0x583F18, 0x59281B, 0x572C17, 0x581F15, 0x522510, 0x592D14, 0x5D490E, 0x3E3112,
+        0x52240E, 0x581E12, 0x3E3312, 0x6E2510, 0x501D0D, 0x5D450F, 0x5A180B, 0x3C3212,
+        0x6E1E0E, 0x5A180B, 0x6E5309, 0x512E06, 0x793606, 0x655606, 0x793606, 0x5B4311,
+        0x634906, 0x6A4F06, 0x511A06, 0x794206, 0x5D490E, 0x522510, 0x5D3309, 0x67420A,
+        0x4C2808, 0x5D2F0A, 0x654F06, 0x654F06, 0x794206, 0x654F05, 0x796E06, 0x000000,
+        0x5A4813, 0x58271B, 0x581F15, 0x582B1B, 0x581E12, 0x52220D, 0x511A06, 0x511A06,
+        0x511A06, 0x794206, 0x794206, 0x794206, 0x706E06, 0x6E6E06, 0x6E6E06, 0x5E5406,
+        0x5E5406, 0x5E5406, 0x511A06, 0x511A06, 0x511A06, 0x794206, 0x794206, 0x794206,
+        0x656D06, 0x65560A, 0x706D0A, 0x5E5406, 0x5E5406, 0x5E5406, 0x087F2C, 0x017F13
+    };
+
+    const int amplitudeData[] =
+    {
+        0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x080A0D, 0x070B0D, 0x080D0E,
+        0x080E0F, 0x010D0F, 0x010C0F, 0x000C0F, 0x010B0F, 0x00090C, 0x070B0D, 0x050B0C,
+        0x010C0F, 0x000C0F, 0x060C0D, 0x01080D, 0x00080D, 0x070C0E, 0x00080D, 0x050A0C,
+        0x01080D, 0x00080D, 0x080A0D, 0x00030C, 0x000909, 0x030609, 0x000000, 0x000000,
+        0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x00030B, 0x01050B,
+        0x00030B, 0x00040B, 0x000000, 0x000000, 0x000001, 0x01050B, 0x0E0A00, 0x010202,
+        0x090E0E, 0x010D0F, 0x000C0F, 0x010D0F, 0x000C0F, 0x00080D, 0x000002, 0x000104,
+        0x000000, 0x000002, 0x000104, 0x000000, 0x000001, 0x000104, 0x000000, 0x000001,
+        0x000104, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000,
+        0x000000, 0x070A0C, 0x000000, 0x000000, 0x050A00, 0x000000, 0x13000F, 0x10000F
+    };
+
+    const int sampleTable[] =
+    {
+        0x38, 0x84, 0x6B, 0x19, 0xC6, 0x63, 0x18, 0x86, 0x73, 0x98, 0xC6, 0xB1, 0x1C, 0xCA, 0x31, 0x8C,
+        0xC7, 0x31, 0x88, 0xC2, 0x30, 0x98, 0x46, 0x31, 0x18, 0xC6, 0x35, 0x0C, 0xCA, 0x31, 0x0C, 0xC6,
+        0x21, 0x10, 0x24, 0x69, 0x12, 0xC2, 0x31, 0x14, 0xC4, 0x71, 0x08, 0x4A, 0x22, 0x49, 0xAB, 0x6A,
+        0xA8, 0xAC, 0x49, 0x51, 0x32, 0xD5, 0x52, 0x88, 0x93, 0x6C, 0x94, 0x22, 0x15, 0x54, 0xD2, 0x25,
+        0x96, 0xD4, 0x50, 0xA5, 0x46, 0x21, 0x08, 0x85, 0x6B, 0x18, 0xC4, 0x63, 0x10, 0xCE, 0x6B, 0x18,
+        0x8C, 0x71, 0x19, 0x8C, 0x63, 0x35, 0x0C, 0xC6, 0x33, 0x99, 0xCC, 0x6C, 0xB5, 0x4E, 0xA2, 0x99,
+        0x46, 0x21, 0x28, 0x82, 0x95, 0x2E, 0xE3, 0x30, 0x9C, 0xC5, 0x30, 0x9C, 0xA2, 0xB1, 0x9C, 0x67,
+        0x31, 0x88, 0x66, 0x59, 0x2C, 0x53, 0x18, 0x84, 0x67, 0x50, 0xCA, 0xE3, 0x0A, 0xAC, 0xAB, 0x30,
+        0xAC, 0x62, 0x30, 0x8C, 0x63, 0x10, 0x94, 0x62, 0xB1, 0x8C, 0x82, 0x28, 0x96, 0x33, 0x98, 0xD6,
+        0xB5, 0x4C, 0x62, 0x29, 0xA5, 0x4A, 0xB5, 0x9C, 0xC6, 0x31, 0x14, 0xD6, 0x38, 0x9C, 0x4B, 0xB4,
+        0x86, 0x65, 0x18, 0xAE, 0x67, 0x1C, 0xA6, 0x63, 0x19, 0x96, 0x23, 0x19, 0x84, 0x13, 0x08, 0xA6,
+        0x52, 0xAC, 0xCA, 0x22, 0x89, 0x6E, 0xAB, 0x19, 0x8C, 0x62, 0x34, 0xC4, 0x62, 0x19, 0x86, 0x63,
+        0x18, 0xC4, 0x23, 0x58, 0xD6, 0xA3, 0x50, 0x42, 0x54, 0x4A, 0xAD, 0x4A, 0x25, 0x11, 0x6B, 0x64,
+        0x89, 0x4A, 0x63, 0x39, 0x8A, 0x23, 0x31, 0x2A, 0xEA, 0xA2, 0xA9, 0x44, 0xC5, 0x12, 0xCD, 0x42,
+        0x34, 0x8C, 0x62, 0x18, 0x8C, 0x63, 0x11, 0x48, 0x66, 0x31, 0x9D, 0x44, 0x33, 0x1D, 0x46, 0x31,
+        0x9C, 0xC6, 0xB1, 0x0C, 0xCD, 0x32, 0x88, 0xC4, 0x73, 0x18, 0x86, 0x73, 0x08, 0xD6, 0x63, 0x58,
+        0x07, 0x81, 0xE0, 0xF0, 0x3C, 0x07, 0x87, 0x90, 0x3C, 0x7C, 0x0F, 0xC7, 0xC0, 0xC0, 0xF0, 0x7C,
+        0x1E, 0x07, 0x80, 0x80, 0x00, 0x1C, 0x78, 0x70, 0xF1, 0xC7, 0x1F, 0xC0, 0x0C, 0xFE, 0x1C, 0x1F,
+        0x1F, 0x0E, 0x0A, 0x7A, 0xC0, 0x71, 0xF2, 0x83, 0x8F, 0x03, 0x0F, 0x0F, 0x0C, 0x00, 0x79, 0xF8,
+        0x61, 0xE0, 0x43, 0x0F, 0x83, 0xE7, 0x18, 0xF9, 0xC1, 0x13, 0xDA, 0xE9, 0x63, 0x8F, 0x0F, 0x83,
+        0x83, 0x87, 0xC3, 0x1F, 0x3C, 0x70, 0xF0, 0xE1, 0xE1, 0xE3, 0x87, 0xB8, 0x71, 0x0E, 0x20, 0xE3,
+        0x8D, 0x48, 0x78, 0x1C, 0x93, 0x87, 0x30, 0xE1, 0xC1, 0xC1, 0xE4, 0x78, 0x21, 0x83, 0x83, 0xC3,
+        0x87, 0x06, 0x39, 0xE5, 0xC3, 0x87, 0x07, 0x0E, 0x1C, 0x1C, 0x70, 0xF4, 0x71, 0x9C, 0x60, 0x36,
+        0x32, 0xC3, 0x1E, 0x3C, 0xF3, 0x8F, 0x0E, 0x3C, 0x70, 0xE3, 0xC7, 0x8F, 0x0F, 0x0F, 0x0E, 0x3C,
+        0x78, 0xF0, 0xE3, 0x87, 0x06, 0xF0, 0xE3, 0x07, 0xC1, 0x99, 0x87, 0x0F, 0x18, 0x78, 0x70, 0x70,
+        0xFC, 0xF3, 0x10, 0xB1, 0x8C, 0x8C, 0x31, 0x7C, 0x70, 0xE1, 0x86, 0x3C, 0x64, 0x6C, 0xB0, 0xE1,
+        0xE3, 0x0F, 0x23, 0x8F, 0x0F, 0x1E, 0x3E, 0x38, 0x3C, 0x38, 0x7B, 0x8F, 0x07, 0x0E, 0x3C, 0xF4,
+        0x17, 0x1E, 0x3C, 0x78, 0xF2, 0x9E, 0x72, 0x49, 0xE3, 0x25, 0x36, 0x38, 0x58, 0x39, 0xE2, 0xDE,
+        0x3C, 0x78, 0x78, 0xE1, 0xC7, 0x61, 0xE1, 0xE1, 0xB0, 0xF0, 0xF0, 0xC3, 0xC7, 0x0E, 0x38, 0xC0,
+        0xF0, 0xCE, 0x73, 0x73, 0x18, 0x34, 0xB0, 0xE1, 0xC7, 0x8E, 0x1C, 0x3C, 0xF8, 0x38, 0xF0, 0xE1,
+        0xC1, 0x8B, 0x86, 0x8F, 0x1C, 0x78, 0x70, 0xF0, 0x78, 0xAC, 0xB1, 0x8F, 0x39, 0x31, 0xDB, 0x38,
+        0x61, 0xC3, 0x0E, 0x0E, 0x38, 0x78, 0x73, 0x17, 0x1E, 0x39, 0x1E, 0x38, 0x64, 0xE1, 0xF1, 0xC1,
+        0x4E, 0x0F, 0x40, 0xA2, 0x02, 0xC5, 0x8F, 0x81, 0xA1, 0xFC, 0x12, 0x08, 0x64, 0xE0, 0x3C, 0x22,
+        0xE0, 0x45, 0x07, 0x8E, 0x0C, 0x32, 0x90, 0xF0, 0x1F, 0x20, 0x49, 0xE0, 0xF8, 0x0C, 0x60, 0xF0,
+        0x17, 0x1A, 0x41, 0xAA, 0xA4, 0xD0, 0x8D, 0x12, 0x82, 0x1E, 0x1E, 0x03, 0xF8, 0x3E, 0x03, 0x0C,
+        0x73, 0x80, 0x70, 0x44, 0x26, 0x03, 0x24, 0xE1, 0x3E, 0x04, 0x4E, 0x04, 0x1C, 0xC1, 0x09, 0xCC,
+        0x9E, 0x90, 0x21, 0x07, 0x90, 0x43, 0x64, 0xC0, 0x0F, 0xC6, 0x90, 0x9C, 0xC1, 0x5B, 0x03, 0xE2,
+        0x1D, 0x81, 0xE0, 0x5E, 0x1D, 0x03, 0x84, 0xB8, 0x2C, 0x0F, 0x80, 0xB1, 0x83, 0xE0, 0x30, 0x41,
+        0x1E, 0x43, 0x89, 0x83, 0x50, 0xFC, 0x24, 0x2E, 0x13, 0x83, 0xF1, 0x7C, 0x4C, 0x2C, 0xC9, 0x0D,
+        0x83, 0xB0, 0xB5, 0x82, 0xE4, 0xE8, 0x06, 0x9C, 0x07, 0xA0, 0x99, 0x1D, 0x07, 0x3E, 0x82, 0x8F,
+        0x70, 0x30, 0x74, 0x40, 0xCA, 0x10, 0xE4, 0xE8, 0x0F, 0x92, 0x14, 0x3F, 0x06, 0xF8, 0x84, 0x88,
+        0x43, 0x81, 0x0A, 0x34, 0x39, 0x41, 0xC6, 0xE3, 0x1C, 0x47, 0x03, 0xB0, 0xB8, 0x13, 0x0A, 0xC2,
+        0x64, 0xF8, 0x18, 0xF9, 0x60, 0xB3, 0xC0, 0x65, 0x20, 0x60, 0xA6, 0x8C, 0xC3, 0x81, 0x20, 0x30,
+        0x26, 0x1E, 0x1C, 0x38, 0xD3, 0x01, 0xB0, 0x26, 0x40, 0xF4, 0x0B, 0xC3, 0x42, 0x1F, 0x85, 0x32,
+        0x26, 0x60, 0x40, 0xC9, 0xCB, 0x01, 0xEC, 0x11, 0x28, 0x40, 0xFA, 0x04, 0x34, 0xE0, 0x70, 0x4C,
+        0x8C, 0x1D, 0x07, 0x69, 0x03, 0x16, 0xC8, 0x04, 0x23, 0xE8, 0xC6, 0x9A, 0x0B, 0x1A, 0x03, 0xE0,
+        0x76, 0x06, 0x05, 0xCF, 0x1E, 0xBC, 0x58, 0x31, 0x71, 0x66, 0x00, 0xF8, 0x3F, 0x04, 0xFC, 0x0C,
+        0x74, 0x27, 0x8A, 0x80, 0x71, 0xC2, 0x3A, 0x26, 0x06, 0xC0, 0x1F, 0x05, 0x0F, 0x98, 0x40, 0xAE,
+        0x01, 0x7F, 0xC0, 0x07, 0xFF, 0x00, 0x0E, 0xFE, 0x00, 0x03, 0xDF, 0x80, 0x03, 0xEF, 0x80, 0x1B,
+        0xF1, 0xC2, 0x00, 0xE7, 0xE0, 0x18, 0xFC, 0xE0, 0x21, 0xFC, 0x80, 0x3C, 0xFC, 0x40, 0x0E, 0x7E,
+        0x00, 0x3F, 0x3E, 0x00, 0x0F, 0xFE, 0x00, 0x1F, 0xFF, 0x00, 0x3E, 0xF0, 0x07, 0xFC, 0x00, 0x7E,
+        0x10, 0x3F, 0xFF, 0x00, 0x3F, 0x38, 0x0E, 0x7C, 0x01, 0x87, 0x0C, 0xFC, 0xC7, 0x00, 0x3E, 0x04,
+        0x0F, 0x3E, 0x1F, 0x0F, 0x0F, 0x1F, 0x0F, 0x02, 0x83, 0x87, 0xCF, 0x03, 0x87, 0x0F, 0x3F, 0xC0,
+        0x07, 0x9E, 0x60, 0x3F, 0xC0, 0x03, 0xFE, 0x00, 0x3F, 0xE0, 0x77, 0xE1, 0xC0, 0xFE, 0xE0, 0xC3,
+        0xE0, 0x01, 0xDF, 0xF8, 0x03, 0x07, 0x00, 0x7E, 0x70, 0x00, 0x7C, 0x38, 0x18, 0xFE, 0x0C, 0x1E,
+        0x78, 0x1C, 0x7C, 0x3E, 0x0E, 0x1F, 0x1E, 0x1E, 0x3E, 0x00, 0x7F, 0x83, 0x07, 0xDB, 0x87, 0x83,
+        0x07, 0xC7, 0x07, 0x10, 0x71, 0xFF, 0x00, 0x3F, 0xE2, 0x01, 0xE0, 0xC1, 0xC3, 0xE1, 0x00, 0x7F,
+        0xC0, 0x05, 0xF0, 0x20, 0xF8, 0xF0, 0x70, 0xFE, 0x78, 0x79, 0xF8, 0x02, 0x3F, 0x0C, 0x8F, 0x03,
+        0x0F, 0x9F, 0xE0, 0xC1, 0xC7, 0x87, 0x03, 0xC3, 0xC3, 0xB0, 0xE1, 0xE1, 0xC1, 0xE3, 0xE0, 0x71,
+        0xF0, 0x00, 0xFC, 0x70, 0x7C, 0x0C, 0x3E, 0x38, 0x0E, 0x1C, 0x70, 0xC3, 0xC7, 0x03, 0x81, 0xC1,
+        0xC7, 0xE7, 0x00, 0x0F, 0xC7, 0x87, 0x19, 0x09, 0xEF, 0xC4, 0x33, 0xE0, 0xC1, 0xFC, 0xF8, 0x70,
+        0xF0, 0x78, 0xF8, 0xF0, 0x61, 0xC7, 0x00, 0x1F, 0xF8, 0x01, 0x7C, 0xF8, 0xF0, 0x78, 0x70, 0x3C,
+        0x7C, 0xCE, 0x0E, 0x21, 0x83, 0xCF, 0x08, 0x07, 0x8F, 0x08, 0xC1, 0x87, 0x8F, 0x80, 0xC7, 0xE3,
+        0x00, 0x07, 0xF8, 0xE0, 0xEF, 0x00, 0x39, 0xF7, 0x80, 0x0E, 0xF8, 0xE1, 0xE3, 0xF8, 0x21, 0x9F,
+        0xC0, 0xFF, 0x03, 0xF8, 0x07, 0xC0, 0x1F, 0xF8, 0xC4, 0x04, 0xFC, 0xC4, 0xC1, 0xBC, 0x87, 0xF0,
+        0x0F, 0xC0, 0x7F, 0x05, 0xE0, 0x25, 0xEC, 0xC0, 0x3E, 0x84, 0x47, 0xF0, 0x8E, 0x03, 0xF8, 0x03,
+        0xFB, 0xC0, 0x19, 0xF8, 0x07, 0x9C, 0x0C, 0x17, 0xF8, 0x07, 0xE0, 0x1F, 0xA1, 0xFC, 0x0F, 0xFC,
+        0x01, 0xF0, 0x3F, 0x00, 0xFE, 0x03, 0xF0, 0x1F, 0x00, 0xFD, 0x00, 0xFF, 0x88, 0x0D, 0xF9, 0x01,
+        0xFF, 0x00, 0x70, 0x07, 0xC0, 0x3E, 0x42, 0xF3, 0x0D, 0xC4, 0x7F, 0x80, 0xFC, 0x07, 0xF0, 0x5E,
+        0xC0, 0x3F, 0x00, 0x78, 0x3F, 0x81, 0xFF, 0x01, 0xF8, 0x01, 0xC3, 0xE8, 0x0C, 0xE4, 0x64, 0x8F,
+        0xE4, 0x0F, 0xF0, 0x07, 0xF0, 0xC2, 0x1F, 0x00, 0x7F, 0xC0, 0x6F, 0x80, 0x7E, 0x03, 0xF8, 0x07,
+        0xF0, 0x3F, 0xC0, 0x78, 0x0F, 0x82, 0x07, 0xFE, 0x22, 0x77, 0x70, 0x02, 0x76, 0x03, 0xFE, 0x00,
+        0xFE, 0x67, 0x00, 0x7C, 0xC7, 0xF1, 0x8E, 0xC6, 0x3B, 0xE0, 0x3F, 0x84, 0xF3, 0x19, 0xD8, 0x03,
+        0x99, 0xFC, 0x09, 0xB8, 0x0F, 0xF8, 0x00, 0x9D, 0x24, 0x61, 0xF9, 0x0D, 0x00, 0xFD, 0x03, 0xF0,
+        0x1F, 0x90, 0x3F, 0x01, 0xF8, 0x1F, 0xD0, 0x0F, 0xF8, 0x37, 0x01, 0xF8, 0x07, 0xF0, 0x0F, 0xC0,
+        0x3F, 0x00, 0xFE, 0x03, 0xF8, 0x0F, 0xC0, 0x3F, 0x00, 0xFA, 0x03, 0xF0, 0x0F, 0x80, 0xFF, 0x01,
+        0xB8, 0x07, 0xF0, 0x01, 0xFC, 0x01, 0xBC, 0x80, 0x13, 0x1E, 0x00, 0x7F, 0xE1, 0x40, 0x7F, 0xA0,
+        0x7F, 0xB0, 0x00, 0x3F, 0xC0, 0x1F, 0xC0, 0x38, 0x0F, 0xF0, 0x1F, 0x80, 0xFF, 0x01, 0xFC, 0x03,
+        0xF1, 0x7E, 0x01, 0xFE, 0x01, 0xF0, 0xFF, 0x00, 0x7F, 0xC0, 0x1D, 0x07, 0xF0, 0x0F, 0xC0, 0x7E,
+        0x06, 0xE0, 0x07, 0xE0, 0x0F, 0xF8, 0x06, 0xC1, 0xFE, 0x01, 0xFC, 0x03, 0xE0, 0x0F, 0x00, 0xFC
+    };
+
+    const int stressPitchOffsets[] =
+    {
+        0x00, 0xE0, 0xE6, 0xEC, 0xF3, 0xF9, 0x00, 0x06, 0x0C, 0x06
+    };
+
+    const int sampledConsonantValues[] =
+    {
+        0x18, 0x1A, 0x17, 0x17, 0x17
+    };
+
+    const int sineTable[] =
+    {
+        0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45,
+        48, 51, 54, 57, 59, 62, 65, 67, 70, 73, 75, 78, 80, 82, 85, 87,
+        89, 91, 94, 96, 98, 100, 102, 103, 105, 107, 108, 110, 112, 113, 114, 116,
+        117, 118, 119, 120, 121, 122, 123, 123, 124, 125, 125, 126, 126, 126, 126, 126,
+        127, 126, 126, 126, 126, 126, 125, 125, 124, 123, 123, 122, 121, 120, 119, 118,
+        117, 116, 114, 113, 112, 110, 108, 107, 105, 103, 102, 100, 98, 96, 94, 91,
+        89, 87, 85, 82, 80, 78, 75, 73, 70, 67, 65, 62, 59, 57, 54, 51,
+        48, 45, 42, 39, 36, 33, 30, 27, 24, 21, 18, 15, 12, 9, 6, 3,
+        0, -3, -6, -9, -12, -15, -18, -21, -24, -27, -30, -33, -36, -39, -42, -45,
+        -48, -51, -54, -57, -59, -62, -65, -67, -70, -73, -75, -78, -80, -82, -85, -87,
+        -89, -91, -94, -96, -98, -100, -102, -103, -105, -107, -108, -110, -112, -113, -114, -116,
+        -117, -118, -119, -120, -121, -122, -123, -123, -124, -125, -125, -126, -126, -126, -126, -126,
+        -127, -126, -126, -126, -126, -126, -125, -125, -124, -123, -123, -122, -121, -120, -119, -118,
+        -117, -116, -114, -113, -112, -110, -108, -107, -105, -103, -102, -100, -98, -96, -94, -91,
+        -89, -87, -85, -82, -80, -78, -75, -73, -70, -67, -65, -62, -59, -57, -54, -51,
+        -48, -45, -42, -39, -36, -33, -30, -27, -24, -21, -18, -15, -12, -9, -6, -3
+    };
+
+    const char* const englishRules[] =
+    {
+        " (A.)=EH4Y. ", "(A) =AH", " (ARE) =AAR", " (AR)O=AXR",
+        "(AR)#=EH4R", " ^(AS)#=EY4S", "(A)WA=AX", "(AW)=AO5",
+        " :(ANY)=EH4NIY", "(A)^+#=EY5", "#:(ALLY)=ULIY", " (AL)#=UL",
+        "(AGAIN)=AXGEH4N", "#:(AG)E=IHJ", "(A)^%=EY", "(A)^+:#=AE",
+        " :(A)^+ =EY4", " (ARR)=AXR", "(ARR)=AE4R", " ^(AR) =AA5R",
+        "(AR)=AA5R", "(AIR)=EH4R", "(AI)=EY4", "(AY)=EY5",
+        "(AU)=AO4", "#:(AL) =UL", "#:(ALS) =ULZ", "(ALK)=AO4K",
+        "(AL)^=AOL", " :(ABLE)=EY4BUL", "(ABLE)=AXBUL", "(A)VO=EY4",
+        "(ANG)+=EY4NJ", "(ATARI)=AHTAA4RIY", "(A)TOM=AE", "(A)TTI=AE",
+        " (AT) =AET", " (A)T=AH", "(A)=AE", " (B) =BIY4",
+        " (BE)^#=BIH", "(BEING)=BIY4IHNX", " (BOTH) =BOW4TH", " (BUS)#=BIH4Z",
+        "(BREAK)=BREY5K", "(BUIL)=BIH4L", "(B)=B", " (C) =SIY4",
+        " (CH)^=K", "^E(CH)=K", "(CHA)R#=KEH5", "(CH)=CH",
+        " S(CI)#=SAY4", "(CI)A=SH", "(CI)O=SH", "(CI)EN=SH",
+        "(CITY)=SIHTIY", "(C)+=S", "(CK)=K", "(COMMODORE)=KAA4MAHDOHR",
+        "(COM)=KAHM", "(CUIT)=KIHT", "(CREA)=KRIYEY", "(C)=K",
+        " (D) =DIY4", " (DR.) =DAA4KTER", "#:(DED) =DIHD", ".E(D) =D",
+        "#:^E(D) =T", " (DE)^#=DIH", " (DO) =DUW", " (DOES)=DAHZ",
+        "(DONE) =DAH5N", "(DOING)=DUW4IHNX", " (DOW)=DAW", "#(DU)A=JUW",
+        "#(DU)^#=JAX", "(D)=D", " (E) =IYIY4", "#:(E) =",
+        "':^(E) =", " :(E) =IY", "#(ED) =D", "#:(E)D =",
+        "(EV)ER=EH4V", "(E)^%=IY4", "(ERI)#=IY4RIY", "(ERI)=EH4RIH",
+        "#:(ER)#=ER", "(ERROR)=EH4ROHR", "(ERASE)=IHREY5S", "(ER)#=EHR",
+        "(ER)=ER", " (EVEN)=IYVEHN", "#:(E)W=", "@(EW)=UW",
+        "(EW)=YUW", "(E)O=IY", "#:&(ES) =IHZ", "#:(E)S =",
+        "#:(ELY) =LIY", "#:(EMENT)=MEHNT", "(EFUL)=FUHL", "(EE)=IY4",
+        "(EARN)=ER5N", " (EAR)^=ER5", "(EAD)=EHD", "#:(EA) =IYAX",
+        "(EA)SU=EH5", "(EA)=IY5", "(EIGH)=EY4", "(EI)=IY4",
+        " (EYE)=AY4", "(EY)=IY", "(EU)=YUW5", "(EQUAL)=IY4KWUL",
+        "(E)=EH", " (F) =EH4F", "(FUL)=FUHL", "(FRIEND)=FREH5ND",
+        "(FATHER)=FAA4DHER", "(F)F=", "(F)=F", " (G) =JIY4",
+        "(GIV)=GIH5V", " (G)I^=G", "(GE)T=GEH5", "SU(GGES)=GJEH4S",
+        "(GG)=G", " B#(G)=G", "(G)+=J", "(GREAT)=GREY4T",
+        "(GON)E=GAO5N", "#(GH)=", " (GN)=N", "(G)=G",
+        " (H) =EY4CH", " (HAV)=/HAE6V", " (HERE)=/HIYR", " (HOUR)=AW5ER",
+        "(HOW)=/HAW", "(H)#=/H", "(H)=", " (IN)=IHN",
+        " (I) =AY4", "(I) =AY", "(IN)D=AY5N", "SEM(I)=IY",
+        " ANT(I)=AY", "(IER)=IYER", "#:R(IED) =IYD", "(IED) =AY5D",
+        "(IEN)=IYEHN", "(IE)T=AY4EH", "(I')=AY5", " :(I)^%=AY5",
+        " :(IE) =AY4", "(I)%=IY", "(IE)=IY4", " (IDEA)=AYDIY5AH",
+        "(I)^+:#=IH", "(IR)#=AYR", "(IZ)%=AYZ", "(IS)%=AYZ",
+        "I^(I)^#=IH", "+^(I)^+=AY", "#:^(I)^+=IH", "(I)^+=AY",
+        "(IR)=ER", "(IGH)=AY4", "(ILD)=AY5LD", " (IGN)=IHGN",
+        "(IGN) =AY4N", "(IGN)^=AY4N", "(IGN)%=AY4N", "(ICRO)=AY4KROH",
+        "(IQUE)=IY4K", "(I)=IH", " (J) =JEY4", "(J)=J",
+        " (K) =KEY4", " (K)N=", "(K)=K", " (L) =EH4L",
+        "(LO)C#=LOW", "L(L)=", "#:^(L)%=UL", "(LEAD)=LIYD",
+        " (LAUGH)=LAE4F", "(L)=L", " (M) =EH4M", " (MR.) =MIH4STER",
+        " (MS.)=MIH5Z", " (MRS.) =MIH4SIXZ", "(MOV)=MUW4V", "(MACHIN)=MAHSHIY5N",
+        "M(M)=", "(M)=M", " (N) =EH4N", "E(NG)+=NJ",
+        "(NG)R=NXG", "(NG)#=NXG", "(NGL)%=NXGUL", "(NG)=NX",
+        "(NK)=NXK", " (NOW) =NAW4", "N(N)=", "(NON)E=NAH4N",
+        "(N)=N", " (O) =OH4W", "(OF) =AHV", " (OH) =OW5",
+        "(OROUGH)=ER4OW", "#:(OR) =ER", "#:(ORS) =ERZ", "(OR)=AOR",
+        " (ONE)=WAHN", "#(ONE) =WAHN", "(OW)=OW", " (OVER)=OW5VER",
+        "PR(O)V=UW4", "(OV)=AH4V", "(O)^%=OW5", "(O)^EN=OW",
+        "(O)^I#=OW5", "(OL)D=OW4L", "(OUGHT)=AO5T", "(OUGH)=AH5F",
+        " (OU)=AW", "H(OU)S#=AW4", "(OUS)=AXS", "(OUR)=OHR",
+        "(OULD)=UH5D", "(OU)^L=AH5", "(OUP)=UW5P", "(OU)=AW",
+        "(OY)=OY", "(OING)=OW4IHNX", "(OI)=OY5", "(OOR)=OH5R",
+        "(OOK)=UH5K", "F(OOD)=UW5D", "L(OOD)=AH5D", "M(OOD)=UW5D",
+        "(OOD)=UH5D", "F(OOT)=UH5T", "(OO)=UW5", "(O')=OH",
+        "(O)E=OW", "(O) =OW", "(OA)=OW4", " (ONLY)=OW4NLIY",
+        " (ONCE)=WAH4NS", "(ON'T)=OW4NT", "C(O)N=AA", "(O)NG=AO",
+        " :^(O)N=AH", "I(ON)=UN", "#:(ON)=UN", "#^(ON)=UN",
+        "(O)ST=OW", "(OF)^=AO4F", "(OTHER)=AH5DHER", "R(O)B=RAA",
+        "^R(O):#=OW5", "(OSS) =AO5S", "#:^(OM)=AHM", "(O)=AA",
+        " (P) =PIY4", "(PH)=F", "(PEOPL)=PIY5PUL", "(POW)=PAW4",
+        "(PUT) =PUHT", "(P)P=", "(P)S=", "(P)N=",
+        "(PROF.)=PROHFEH4SER", "(P)=P", " (Q) =KYUW4", "(QUAR)=KWOH5R",
+        "(QU)=KW", "(Q)=K", " (R) =AA5R", " (RE)^#=RIY",
+        "(R)R=", "(R)=R", " (S) =EH4S", "(SH)=SH",
+        "#(SION)=ZHUN", "(SOME)=SAHM", "#(SUR)#=ZHER", "(SUR)#=SHER",
+        "#(SU)#=ZHUW", "#(SSU)#=SHUW", "#(SED)=ZD", "#(S)#=Z",
+        "(SAID)=SEHD", "^(SION)=SHUN", "(S)S=", ".(S) =Z",
+        "#:.E(S) =Z", "#:^#(S) =S", "U(S) =S", " :#(S) =Z",
+        "##(S) =Z", " (SCH)=SK", "(S)C+=", "#(SM)=ZUM",
+        "#(SN)'=ZUM", "(STLE)=SUL", "(S)=S", " (T) =TIY4",
+        " (THE) #=DHIY", " (THE) =DHAX", "(TO) =TUX", " (THAT)=DHAET",
+        " (THIS) =DHIHS", " (THEY)=DHEY", " (THERE)=DHEHR", "(THER)=DHER",
+        "(THEIR)=DHEHR", " (THAN) =DHAEN", " (THEM) =DHAEN", "(THESE) =DHIYZ",
+        " (THEN)=DHEHN", "(THROUGH)=THRUW4", "(THOSE)=DHOHZ", "(THOUGH) =DHOW",
+        "(TODAY)=TUXDEY", "(TOMO)RROW=TUMAA5", "(TO)TAL=TOW5", " (THUS)=DHAH4S",
+        "(TH)=TH", "#:(TED)=TIXD", "S(TI)#N=CH", "(TI)O=SH",
+        "(TI)A=SH", "(TIEN)=SHUN", "(TUR)#=CHER", "(TU)A=CHUW",
+        " (TWO)=TUW", "&(T)EN =", "(T)=T", " (U) =YUW4",
+        " (UN)I=YUWN", " (UN)=AHN", " (UPON)=AXPAON", "@(UR)#=UH4R",
+        "(UR)#=YUH4R", "(UR)=ER", "(U)^ =AH", "(U)^^=AH5",
+        "(UY)=AY5", " G(U)#=", "G(U)%=", "G(U)#=W",
+        "#N(U)=YUW", "@(U)=UW", "(U)=YUW", " (V) =VIY4",
+        "(VIEW)=VYUW5", "(V)=V", " (W) =DAH4BULYUW", " (WERE)=WER",
+        "(WA)SH=WAA", "(WA)ST=WEY", "(WA)S=WAH", "(WA)T=WAA",
+        "(WHERE)=WHEHR", "(WHAT)=WHAHT", "(WHOL)=/HOWL", "(WHO)=/HUW",
+        "(WH)=WH", "(WAR)#=WEHR", "(WAR)=WAOR", "(WOR)^=WER",
+        "(WR)=R", "(WOM)A=WUHM", "(WOM)E=WIHM", "(WEA)R=WEH",
+        "(WANT)=WAA5NT", "ANS(WER)=ER", "(W)=W", " (X) =EH4KR",
+        " (X)=Z", "(X)=KS", " (Y) =WAY4", "(YOUNG)=YAHNX",
+        " (YOUR)=YOHR", " (YOU)=YUW", " (YES)=YEHS", " (Y)=Y",
+        "F(Y)=AY", "PS(YCH)=AYK", "#:^(Y)=IY", "#:^(Y)I=IY",
+        " :(Y) =AY", " :(Y)#=AY", " :(Y)^+:#=IH", " :(Y)^#=AY",
+        "(Y)=IH", " (Z) =ZIY4", "(Z)=Z"
+    };
+
+    const char* const symbolRules[] =
+    {
+        "(A)=", "(!)=.", "(\") =-AH5NKWOWT-", "(\")=KWOW4T-",
+        "(#)= NAH4MBER", "($)= DAA4LER", "(%)= PERSEH4NT", "(&)= AEND",
+        "(')=", "(*)= AE4STERIHSK", "(+)= PLAH4S", "(,)=,",
+        " (-) =-", "(-)=", "(.)= POYNT", "(/)= SLAE4SH",
+        "(0)= ZIY4ROW", " (1ST)=FER4ST", " (10TH)=TEH4NTH", "(1)= WAH4N",
+        " (2ND)=SEH4KUND", "(2)= TUW4", " (3RD)=THER4D", "(3)= THRIY4",
+        "(4)= FOH4R", " (5TH)=FIH4FTH", "(5)= FAY4V", " (64) =SIH4KSTIY FOHR",
+        "(6)= SIH4KS", "(7)= SEH4VUN", " (8TH)=EY4TH", "(8)= EY4T",
+        "(9)= NAY4N", "(:)=.", "(;)=.", "(<)= LEH4S DHAEN",
+        "(=)= IY4KWULZ", "(>)= GREY4TER DHAEN", "(?)=?", "(@)= AE6T",
+        "(^)= KAE4RIXT"
+    };
+
+    constexpr int charNumeric = 0x01;
+    constexpr int charRuleset2 = 0x02;
+    constexpr int charVoiced = 0x04;
+    constexpr int char0x08 = 0x08;
+    constexpr int charDiphthong = 0x10;
+    constexpr int charConsonant = 0x20;
+    constexpr int charVowelOrY = 0x40;
+    constexpr int charAlphaOrQuote = 0x80;
+
+    constexpr int flagFricative = 0x2000;
+    constexpr int flagLiquid = 0x1000;
+    constexpr int flagNasal = 0x0800;
+    constexpr int flagAlveolar = 0x0400;
+    constexpr int flagPunctuation = 0x0100;
+    constexpr int flagVowel = 0x0080;
+    constexpr int flagConsonant = 0x0040;
+    constexpr int flagDiphthongYX = 0x0020;
+    constexpr int flagDiphthong = 0x0010;
+    constexpr int flag0x0008 = 0x0008;
+    constexpr int flagVoiced = 0x0004;
+    constexpr int flagStopConsonant = 0x0002;
+    constexpr int flagUnvoicedStopConsonant = 0x0001;
+
+    constexpr int noPhoneme = -1;
+    constexpr int phonemePeriod = 1;
+    constexpr int phonemeQuestion = 2;
+    constexpr int phonemeR = 23;
+    constexpr int phonemeD = 57;
+    constexpr int phonemeT = 69;
+
+    // Anything the JS pipeline would throw on. The bridge turns these into a
+    // failed render, so they never escape SamEngine::render.
+    struct ScriptError : std::runtime_error
+    {
+        using std::runtime_error::runtime_error;
+    };
+
+    //==============================================================================
+    // The renderer relies on JS number semantics: frame tables are plain arrays
+    // whose out-of-range reads are undefined (NaN in arithmetic, 0 once it hits a
+    // bitwise operator), and every bitwise operator truncates through ToInt32.
+    double undefinedValue()
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    int32_t toInt32 (double value)
+    {
+        if (! std::isfinite (value))
+            return 0;
+
+        const auto truncated = std::trunc (value);
+        if (truncated >= -2147483648.0 && truncated <= 2147483647.0)
+            return static_cast<int32_t> (truncated);
+
+        auto wrapped = std::fmod (truncated, 4294967296.0);
+        if (wrapped < 0.0)
+            wrapped += 4294967296.0;
+        return static_cast<int32_t> (static_cast<uint32_t> (wrapped));
+    }
+
+    class FrameTable
+    {
+    public:
+        double get (int index) const
+        {
+            if (index >= 0)
+                return index < length() ? values[static_cast<size_t> (index)] : undefinedValue();
+
+            const auto slot = static_cast<size_t> (-1 - index);
+            return slot < negativeValues.size() ? negativeValues[slot] : undefinedValue();
+        }
+
+        void set (int index, double value)
+        {
+            auto& target = index >= 0 ? values : negativeValues;
+            const auto slot = static_cast<size_t> (index >= 0 ? index : -1 - index);
+            if (slot >= target.size())
+                target.resize (slot + 1, undefinedValue());
+            target[slot] = value;
+        }
+
+        int length() const
+        {
+            return static_cast<int> (values.size());
+        }
+
+        void clear()
+        {
+            values.clear();
+            negativeValues.clear();
+        }
+
+    private:
+        std::vector<double> values;
+        std::vector<double> negativeValues;
+    };
+
+    //==============================================================================
+    char charAt (const std::string& text, int index)
+    {
+        return (index >= 0 && index < static_cast<int> (text.size())) ? text[static_cast<size_t> (index)] : '\0';
+    }
+
+    bool isKnownChar (char c)
+    {
+        const auto code = static_cast<unsigned char> (c);
+        return code < 128 && charFlags[code] >= 0;
+    }
+
+    bool hasCharFlag (char c, int flag)
+    {
+        return isKnownChar (c) && (charFlags[static_cast<unsigned char> (c)] & flag) != 0;
+    }
+
+    std::string jsSubstr (const std::string& text, int start, int length)
+    {
+        const auto size = static_cast<int> (text.size());
+        if (start < 0)
+            start = std::max (0, size + start);
+        if (start >= size || length <= 0)
+            return {};
+        return text.substr (static_cast<size_t> (start), static_cast<size_t> (std::min (length, size - start)));
+    }
+
+    bool isOneOf (char c, const char* list)
+    {
+        for (; *list != '\0'; ++list)
+            if (*list == c)
+                return true;
+        return false;
+    }
+
+    void decodeUtf8 (const std::string& text, std::vector<char32_t>& out)
+    {
+        out.clear();
+        out.reserve (text.size());
+
+        for (size_t i = 0; i < text.size();)
+        {
+            const auto lead = static_cast<unsigned char> (text[i]);
+            const int extra = lead < 0x80 ? 0 : (lead >> 5) == 0x06 ? 1 : (lead >> 4) == 0x0e ? 2 : (lead >> 3) == 0x1e ? 3 : -1;
+            if (extra < 0 || i + static_cast<size_t> (extra) >= text.size() + (extra == 0 ? 1 : 0))
+            {
+                out.push_back (0xfffd);
+                ++i;
+                continue;
+            }
+
+            char32_t cp = extra == 0 ? lead : (lead & (0x3f >> extra));
+            bool valid = true;
+            for (int k = 1; k <= extra; ++k)
+            {
+                const auto next = static_cast<unsigned char> (text[i + static_cast<size_t> (k)]);
+                valid = valid && (next & 0xc0) == 0x80;
+                cp = (cp << 6) | (next & 0x3f);
+            }
+
+            out.push_back (valid ? cp : 0xfffd);
+            i += valid ? static_cast<size_t> (extra + 1) : 1;
+        }
+    }
+
+    bool isScriptWhitespace (char32_t cp)
+    {
+        return (cp >= 0x09 && cp <= 0x0d) || cp == 0x20 || cp == 0xa0 || cp == 0x1680
+            || (cp >= 0x2000 && cp <= 0x200a) || cp == 0x2028 || cp == 0x2029
+            || cp == 0x202f || cp == 0x205f || cp == 0x3000 || cp == 0xfeff;
+    }
+
+    // String.prototype.trim() followed by toUpperCase(). Only the code points whose
+    // upper case is plain ASCII can ever be spoken; every other non-ASCII character
+    // becomes a byte the reciter and parser reject, exactly as they reject the original.
+    void toScriptText (const std::string& utf8Text, std::vector<char32_t>& codePoints, std::string& out)
+    {
+        decodeUtf8 (utf8Text, codePoints);
+        auto first = codePoints.begin();
+        auto last = codePoints.end();
+        while (first != last && isScriptWhitespace (*first))
+            ++first;
+        while (last != first && isScriptWhitespace (*(last - 1)))
+            --last;
+
+        out.clear();
+        out.reserve (static_cast<size_t> (last - first));
+
+        for (auto it = first; it != last; ++it)
+        {
+            const auto cp = *it;
+            if (cp < 0x80)
+            {
+                out += static_cast<char> (cp >= 'a' && cp <= 'z' ? cp - 'a' + 'A' : cp);
+                continue;
+            }
+
+            switch (cp)
+            {
+                case 0x00df: out += "SS"; break;
+                case 0x0131: out += "I"; break;
+                case 0x017f: out += "S"; break;
+                case 0xfb00: out += "FF"; break;
+                case 0xfb01: out += "FI"; break;
+                case 0xfb02: out += "FL"; break;
+                case 0xfb03: out += "FFI"; break;
+                case 0xfb04: out += "FFL"; break;
+                case 0xfb05:
+                case 0xfb06: out += "ST"; break;
+                default:     out += '\x7f'; break;
+            }
+        }
+    }
+
+    //==============================================================================
+    class Reciter
+    {
+    public:
+        // Returns false if the text holds a character the rules cannot speak. text is
+        // working space.
+        static bool textToPhonemes (const std::string& input, std::string& text, std::string& output)
+        {
+            const auto& rules = getRules();
+            text.assign (1, ' ');
+            text += input;
+            const auto size = static_cast<int> (text.size());
+
+            output.clear();
+            int inputPos = 0;
+
+            auto applyFirstMatch = [&] (const std::vector<Rule>& candidates)
+            {
+                for (const auto& rule : candidates)
+                {
+                    if (rule.matches (text, inputPos))
+                    {
+                        output += rule.target;
+                        inputPos += static_cast<int> (rule.match.size());
+                        return;
+                    }
+                }
+            };
+
+            for (int iterations = 0; inputPos < size && iterations++ < 10000;)
+            {
+                const auto currentChar = text[static_cast<size_t> (inputPos)];
+
+                if (currentChar != '.' || hasCharFlag (charAt (text, inputPos + 1), charNumeric))
+                {
+                    if (hasCharFlag (currentChar, charRuleset2))
+                    {
+                        applyFirstMatch (rules.symbols);
+                        continue;
+                    }
+
+                    if (! isKnownChar (currentChar) || charFlags[static_cast<unsigned char> (currentChar)] != 0)
+                    {
+                        if (! hasCharFlag (currentChar, charAlphaOrQuote))
+                            return false;
+
+                        applyFirstMatch (rules.letters[static_cast<unsigned char> (currentChar)]);
+                        continue;
+                    }
+
+                    output += ' ';
+                    ++inputPos;
+                    continue;
+                }
+
+                output += '.';
+                ++inputPos;
+            }
+
+            return true;
+        }
+
+    private:
+        struct Rule
+        {
+            std::string prefix, match, suffix, target;
+
+            explicit Rule (const std::string& rule)
+            {
+                const auto equals = rule.rfind ('=');
+                const auto open = rule.find ('(');
+                const auto close = rule.find (')');
+                prefix = rule.substr (0, open);
+                match = rule.substr (open + 1, close - open - 1);
+                suffix = rule.substr (close + 1, equals - close - 1);
+                target = rule.substr (equals + 1);
+            }
+
+            bool matches (const std::string& text, int pos) const
+            {
+                if (text.compare (static_cast<size_t> (pos), match.size(), match) != 0)
+                    return false;
+
+                return checkPrefix (text, pos) && checkSuffix (text, pos + static_cast<int> (match.size()) - 1);
+            }
+
+            bool checkPrefix (const std::string& text, int pos) const
+            {
+                for (auto rulePos = static_cast<int> (prefix.size()) - 1; rulePos >= 0; --rulePos)
+                {
+                    const auto ruleByte = prefix[static_cast<size_t> (rulePos)];
+                    if (hasCharFlag (ruleByte, charAlphaOrQuote))
+                    {
+                        if (charAt (text, --pos) != ruleByte)
+                            return false;
+                        continue;
+                    }
+
+                    bool matched = false;
+                    switch (ruleByte)
+                    {
+                        case ' ': matched = ! hasCharFlag (charAt (text, --pos), charAlphaOrQuote); break;
+                        case '#': matched = hasCharFlag (charAt (text, --pos), charVowelOrY); break;
+                        case '.': matched = hasCharFlag (charAt (text, --pos), char0x08); break;
+                        case '@': matched = hasCharFlag (charAt (text, --pos), charVoiced); break;
+                        case '^': matched = hasCharFlag (charAt (text, --pos), charConsonant); break;
+                        case '+': matched = isOneOf (charAt (text, --pos), "EIY"); break;
+                        case '&':
+                            matched = hasCharFlag (charAt (text, --pos), charDiphthong);
+                            if (! matched)
+                            {
+                                const auto pair = jsSubstr (text, --pos, 2);
+                                matched = pair == "CH" || pair == "SH";
+                            }
+                            break;
+                        case ':':
+                            while (pos >= 0 && hasCharFlag (charAt (text, pos - 1), charConsonant))
+                                --pos;
+                            matched = true;
+                            break;
+                        default:
+                            throw ScriptError ("Unknown reciter rule prefix");
+                    }
+
+                    if (! matched)
+                        return false;
+                }
+
+                return true;
+            }
+
+            bool checkSuffix (const std::string& text, int pos) const
+            {
+                for (const auto ruleByte : suffix)
+                {
+                    if (hasCharFlag (ruleByte, charAlphaOrQuote))
+                    {
+                        if (charAt (text, ++pos) != ruleByte)
+                            return false;
+                        continue;
+                    }
+
+                    bool matched = false;
+                    switch (ruleByte)
+                    {
+                        case ' ': matched = ! hasCharFlag (charAt (text, ++pos), charAlphaOrQuote); break;
+                        case '#': matched = hasCharFlag (charAt (text, ++pos), charVowelOrY); break;
+                        case '.': matched = hasCharFlag (charAt (text, ++pos), char0x08); break;
+                        case '@': matched = hasCharFlag (charAt (text, ++pos), charVoiced); break;
+                        case '^': matched = hasCharFlag (charAt (text, ++pos), charConsonant); break;
+                        case '+': matched = isOneOf (charAt (text, ++pos), "EIY"); break;
+                        case '&':
+                            matched = hasCharFlag (charAt (text, ++pos), charDiphthong);
+                            if (! matched)
+                            {
+                                const auto pair = jsSubstr (text, ++pos - 2, 2);
+                                matched = pair == "HC" || pair == "HS";
+                            }
+                            break;
+                        case ':':
+                            while (hasCharFlag (charAt (text, pos + 1), charConsonant))
+                                ++pos;
+                            matched = true;
+                            break;
+                        case '%':
+                            matched = matchesSuffixEnding (text, pos);
+                            break;
+                        default:
+                            throw ScriptError ("Unknown reciter rule suffix");
+                    }
+
+                    if (! matched)
+                        return false;
+                }
+
+                return true;
+            }
+
+            // 'ING', 'E' not followed by a letter, 'ER', 'ES', 'ED', 'EFUL' or 'ELY'.
+            static bool matchesSuffixEnding (const std::string& text, int& pos)
+            {
+                if (charAt (text, pos + 1) != 'E')
+                {
+                    if (jsSubstr (text, pos + 1, 3) != "ING")
+                        return false;
+                    pos += 3;
+                    return true;
+                }
+
+                if (! hasCharFlag (charAt (text, pos + 2), charAlphaOrQuote))
+                {
+                    ++pos;
+                    return true;
+                }
+
+                if (! isOneOf (charAt (text, pos + 2), "RSD"))
+                {
+                    if (charAt (text, pos + 2) != 'L')
+                    {
+                        if (jsSubstr (text, pos + 2, 3) != "FUL")
+                            return false;
+                        pos += 4;
+                        return true;
+                    }
+
+                    if (charAt (text, pos + 3) != 'Y')
+                        return false;
+                    pos += 3;
+                    return true;
+                }
+
+                pos += 2;
+                return true;
+            }
+        };
+
+        struct RuleSet
+        {
+            std::array<std::vector<Rule>, 128> letters;
+            std::vector<Rule> symbols;
+        };
+
+        static const RuleSet& getRules()
+        {
+            static const RuleSet ruleSet = []
+            {
+                RuleSet r;
+                for (const auto* rule : englishRules)
+                {
+                    Rule parsed (rule);
+                    r.letters[static_cast<unsigned char> (parsed.match[0])].push_back (std::move (parsed));
+                }
+                for (const auto* rule : symbolRules)
+                    r.symbols.emplace_back (rule);
+                return r;
+            }();
+            return ruleSet;
+        }
+    };
+
+    //==============================================================================
+    struct Phoneme
+    {
+        int index = 0;
+        int length = 0;
+        int stress = 0;
+    };
+
+    int phonemeFlagsOf (int phoneme)
+    {
+        return (phoneme >= 0 && phoneme < static_cast<int> (std::size (phonemeFlags))) ? phonemeFlags[phoneme] : 0;
+    }
+
+    bool phonemeHasFlag (int phoneme, int flag)
+    {
+        return (phonemeFlagsOf (phoneme) & flag) != 0;
+    }
+
+    int phonemeLengthOf (int phoneme)
+    {
+        return (phoneme >= 0 && phoneme < static_cast<int> (std::size (phonemeLengths))) ? phonemeLengths[phoneme] : 0;
+    }
+
+    class PhonemeParser
+    {
+    public:
+        void parse (const std::string& input, std::vector<Phoneme>& result)
+        {
+            indices.clear();
+            lengths.clear();
+            stresses.clear();
+
+            parsePhonemeNames (input);
+            applyRewriteRules();
+            copyStress();
+            setPhonemeLengths();
+            adjustLengths();
+            prolongPlosiveStopConsonants();
+
+            result.clear();
+            for (size_t i = 0; i < indices.size(); ++i)
+                if (indices[i] > 0)
+                    result.push_back ({ indices[i], lengths[i], stresses[i] });
+        }
+
+    private:
+        int size() const
+        {
+            return static_cast<int> (indices.size());
+        }
+
+        int getPhoneme (int pos) const
+        {
+            if (pos < 0 || pos > size())
+                throw ScriptError ("Out of bounds: " + std::to_string (pos));
+            return pos == size() ? noPhoneme : indices[static_cast<size_t> (pos)];
+        }
+
+        void setPhoneme (int pos, int value)
+        {
+            indices[static_cast<size_t> (pos)] = value;
+        }
+
+        int getStress (int pos) const
+        {
+            return (pos >= 0 && pos < size()) ? stresses[static_cast<size_t> (pos)] : 0;
+        }
+
+        void setStress (int pos, int value)
+        {
+            stresses[static_cast<size_t> (pos)] = value;
+        }
+
+        int getLength (int pos) const
+        {
+            return (pos >= 0 && pos < size()) ? lengths[static_cast<size_t> (pos)] : 0;
+        }
+
+        void setLength (int pos, int length)
+        {
+            if ((length & 128) != 0)
+                throw ScriptError ("Got the flag 0x80, see CopyStress() and SetPhonemeLength() comments!");
+            if (pos < 0 || pos > size())
+                throw ScriptError ("Out of bounds: " + std::to_string (pos));
+            if (pos < size())
+                lengths[static_cast<size_t> (pos)] = length;
+        }
+
+        void insertPhoneme (int pos, int value, int stress, int length = 0)
+        {
+            const auto offset = static_cast<std::ptrdiff_t> (pos);
+            indices.insert (indices.begin() + offset, value);
+            lengths.insert (lengths.begin() + offset, length);
+            stresses.insert (stresses.begin() + offset, stress);
+        }
+
+        // Parser1: split the phoneme string into table indices and stress marks.
+        void parsePhonemeNames (const std::string& input)
+        {
+            const auto inputSize = static_cast<int> (input.size());
+            for (int srcPos = 0; srcPos < inputSize; ++srcPos)
+            {
+                const auto sign1 = input[static_cast<size_t> (srcPos)];
+                const auto sign2 = charAt (input, srcPos + 1);
+
+                if (const auto match = findPhonemeName (sign1, sign2); match >= 0)
+                {
+                    ++srcPos;
+                    addPhoneme (match);
+                    continue;
+                }
+
+                if (const auto match = findPhonemeName (sign1, '*'); match >= 0)
+                {
+                    addPhoneme (match);
+                    continue;
+                }
+
+                if (sign1 < '1' || sign1 > '8')
+                    throw ScriptError (std::string ("Could not parse char ") + sign1);
+
+                if (! stresses.empty())
+                    stresses.back() = sign1 - '0';
+            }
+        }
+
+        static int findPhonemeName (char sign1, char sign2)
+        {
+            if (sign2 == '\0')
+                return -1;
+
+            for (int i = 0; i < static_cast<int> (std::size (phonemeNames)); ++i)
+                if (phonemeNames[i][0] == sign1 && phonemeNames[i][1] == sign2)
+                    return i;
+            return -1;
+        }
+
+        void addPhoneme (int index)
+        {
+            indices.push_back (index);
+            lengths.push_back (0);
+            stresses.push_back (0);
+        }
+
+        // Parser2: context-dependent phoneme rewrites (diphthong glides, UL/UM/UN,
+        // glottal stops, R/L colouring, G/K fronting, S+stop voicing, T/D flapping).
+        void applyRewriteRules()
+        {
+            int pos = -1;
+            int phoneme = 0;
+            while ((phoneme = getPhoneme (++pos)) != noPhoneme)
+            {
+                if (phoneme == 0)
+                    continue;
+
+                if (phonemeHasFlag (phoneme, flagDiphthong))
+                {
+                    insertPhoneme (pos + 1, phonemeHasFlag (phoneme, flagDiphthongYX) ? 21 : 20, getStress (pos));
+                    handleUwChJ (phoneme, pos);
+                    continue;
+                }
+
+                if (phoneme == 78 || phoneme == 79 || phoneme == 80)
+                {
+                    static constexpr int suffixes[] = { 24, 27, 28 };
+                    setPhoneme (pos, 13);
+                    insertPhoneme (pos + 1, suffixes[phoneme - 78], getStress (pos));
+                    continue;
+                }
+
+                if (phonemeHasFlag (phoneme, flagVowel) && getStress (pos) != 0)
+                {
+                    if (getPhoneme (pos + 1) == 0)
+                    {
+                        phoneme = getPhoneme (pos + 2);
+                        if (phoneme != noPhoneme && phonemeHasFlag (phoneme, flagVowel) && getStress (pos + 2) != 0)
+                            insertPhoneme (pos + 2, 31, 0);
+                    }
+                    continue;
+                }
+
+                const auto priorPhoneme = pos == 0 ? noPhoneme : getPhoneme (pos - 1);
+
+                if (phoneme == phonemeR)
+                {
+                    if (priorPhoneme == phonemeT)
+                        setPhoneme (pos - 1, 42);
+                    else if (priorPhoneme == phonemeD)
+                        setPhoneme (pos - 1, 44);
+                    else if (phonemeHasFlag (priorPhoneme, flagVowel))
+                        setPhoneme (pos, 18);
+                    continue;
+                }
+
+                if (phoneme == 24 && phonemeHasFlag (priorPhoneme, flagVowel))
+                {
+                    setPhoneme (pos, 19);
+                    continue;
+                }
+
+                if (priorPhoneme == 60 && phoneme == 32)
+                {
+                    setPhoneme (pos, 38);
+                    continue;
+                }
+
+                if (phoneme == 60)
+                {
+                    const auto next = getPhoneme (pos + 1);
+                    if (! phonemeHasFlag (next, flagDiphthongYX) && next != noPhoneme)
+                        setPhoneme (pos, 63);
+                    continue;
+                }
+
+                if (phoneme == 72)
+                {
+                    const auto next = getPhoneme (pos + 1);
+                    if (! phonemeHasFlag (next, flagDiphthongYX) || next == noPhoneme)
+                    {
+                        setPhoneme (pos, 75);
+                        phoneme = 75;
+                    }
+                }
+
+                if (phonemeHasFlag (phoneme, flagUnvoicedStopConsonant) && priorPhoneme == 32)
+                    setPhoneme (pos, phoneme - 12);
+                else if (! phonemeHasFlag (phoneme, flagUnvoicedStopConsonant))
+                    handleUwChJ (phoneme, pos);
+
+                if ((phoneme == phonemeT || phoneme == phonemeD)
+                    && pos > 0 && phonemeHasFlag (getPhoneme (pos - 1), flagVowel))
+                {
+                    phoneme = getPhoneme (pos + 1);
+                    if (phoneme == 0)
+                        phoneme = getPhoneme (pos + 2);
+                    if (phonemeHasFlag (phoneme, flagVowel) && getStress (pos + 1) == 0)
+                        setPhoneme (pos, 30);
+                }
+            }
+        }
+
+        void handleUwChJ (int phoneme, int pos)
+        {
+            if (phoneme == 53)
+            {
+                if (phonemeHasFlag (getPhoneme (pos - 1), flagAlveolar))
+                    setPhoneme (pos, 16);
+            }
+            else if (phoneme == 42 || phoneme == 44)
+            {
+                insertPhoneme (pos + 1, phoneme + 1, getStress (pos));
+            }
+        }
+
+        void copyStress()
+        {
+            for (int position = 0; getPhoneme (position) != noPhoneme; ++position)
+            {
+                if (! phonemeHasFlag (getPhoneme (position), flagConsonant))
+                    continue;
+
+                const auto next = getPhoneme (position + 1);
+                if (next != noPhoneme && phonemeHasFlag (next, flagVowel))
+                {
+                    const auto stress = getStress (position + 1);
+                    if (stress != 0 && stress < 0x80)
+                        setStress (position, stress + 1);
+                }
+            }
+        }
+
+        void setPhonemeLengths()
+        {
+            for (int position = 0; getPhoneme (position) != noPhoneme; ++position)
+            {
+                const auto stress = getStress (position);
+                const auto packed = phonemeLengthOf (getPhoneme (position));
+                setLength (position, (stress == 0 || stress > 0x7f) ? (packed & 0xff) : (packed >> 8));
+            }
+        }
+
+        void adjustLengths()
+        {
+            // Lengthen <!FRICATIVE> or <VOICED> between <VOWEL> and <PUNCTUATION> by 1.5.
+            // Note that the scan back deliberately reuses the outer loop position.
+            for (int position = 0; getPhoneme (position) != noPhoneme; ++position)
+            {
+                if (! phonemeHasFlag (getPhoneme (position), flagPunctuation))
+                    continue;
+
+                const auto loopIndex = position;
+                while (--position > 1 && ! phonemeHasFlag (getPhoneme (position), flagVowel)) {}
+                if (position == 0)
+                    break;
+
+                for (; position < loopIndex; ++position)
+                {
+                    if (! phonemeHasFlag (getPhoneme (position), flagFricative) || phonemeHasFlag (getPhoneme (position), flagVoiced))
+                    {
+                        const auto a = getLength (position);
+                        setLength (position, (a >> 1) + a + 1);
+                    }
+                }
+            }
+
+            int loopIndex = -1;
+            int phoneme = 0;
+            while ((phoneme = getPhoneme (++loopIndex)) != noPhoneme)
+            {
+                auto position = loopIndex;
+
+                if (phonemeHasFlag (phoneme, flagVowel))
+                {
+                    phoneme = getPhoneme (++position);
+                    if (! phonemeHasFlag (phoneme, flagConsonant))
+                    {
+                        if ((phoneme == 18 || phoneme == 19) && phonemeHasFlag (getPhoneme (++position), flagConsonant))
+                            setLength (loopIndex, getLength (loopIndex) - 1);
+                        continue;
+                    }
+
+                    const auto flags = phonemeFlagsOf (phoneme);
+                    const auto a = getLength (loopIndex);
+                    if ((flags & flagVoiced) == 0)
+                    {
+                        if ((flags & flagUnvoicedStopConsonant) != 0)
+                            setLength (loopIndex, a - (a >> 3));
+                        continue;
+                    }
+
+                    setLength (loopIndex, (a >> 2) + a + 1);
+                    continue;
+                }
+
+                if (phonemeHasFlag (phoneme, flagNasal))
+                {
+                    phoneme = getPhoneme (++position);
+                    if (phoneme != noPhoneme && phonemeHasFlag (phoneme, flagStopConsonant))
+                    {
+                        setLength (position, 6);
+                        setLength (position - 1, 5);
+                    }
+                    continue;
+                }
+
+                if (phonemeHasFlag (phoneme, flagStopConsonant))
+                {
+                    while ((phoneme = getPhoneme (++position)) == 0) {}
+                    if (phoneme != noPhoneme && phonemeHasFlag (phoneme, flagStopConsonant))
+                    {
+                        setLength (position, (getLength (position) >> 1) + 1);
+                        setLength (loopIndex, (getLength (loopIndex) >> 1) + 1);
+                    }
+                    continue;
+                }
+
+                if (position > 0 && phonemeHasFlag (phoneme, flagLiquid) && phonemeHasFlag (getPhoneme (position - 1), flagStopConsonant))
+                    setLength (position, getLength (position) - 2);
+            }
+        }
+
+        void prolongPlosiveStopConsonants()
+        {
+            int pos = -1;
+            int index = 0;
+            while ((index = getPhoneme (++pos)) != noPhoneme)
+            {
+                if (! phonemeHasFlag (index, flagStopConsonant))
+                    continue;
+
+                if (phonemeHasFlag (index, flagUnvoicedStopConsonant))
+                {
+                    int next = 0;
+                    auto x = pos;
+                    do
+                    {
+                        next = getPhoneme (++x);
+                    } while (next == 0);
+
+                    if (next != noPhoneme && (phonemeHasFlag (next, flag0x0008) || next == 36 || next == 37))
+                        continue;
+                }
+
+                insertPhoneme (pos + 1, index + 1, getStress (pos), phonemeLengthOf (index + 1) & 0xff);
+                insertPhoneme (pos + 2, index + 2, getStress (pos), phonemeLengthOf (index + 2) & 0xff);
+                pos += 2;
+            }
+        }
+
+        std::vector<int> indices;
+        std::vector<int> lengths;
+        std::vector<int> stresses;
+    };
+
+    //==============================================================================
+    class OutputBuffer
+    {
+    public:
+        OutputBuffer (int32_t size, std::vector<uint8_t>& bufferIn, const SamEngine::ChunkCallback* listenerIn)
+            : listener (listenerIn),
+              buffer (bufferIn)
+        {
+            if (size < 0)
+                throw ScriptError ("Invalid typed array length");
+            capacity = size;
+            buffer.clear();
+        }
+
+        void write (int index, int value)
+        {
+            const auto scaled = (value & 15) * 16;
+            writeBlock (index, { scaled, scaled, scaled, scaled, scaled });
+        }
+
+        void writeBlock (int index, const std::array<int, 5>& values)
+        {
+            static constexpr int timetable[5][5] =
+            {
+                { 162, 167, 167, 127, 128 },
+                { 226, 60, 60, 0, 0 },
+                { 225, 60, 59, 0, 0 },
+                { 200, 0, 0, 54, 55 },
+                { 199, 0, 0, 54, 54 }
+            };
+
+            bufferPos += timetable[oldTimetableIndex][index];
+            const auto start = bufferPos / 50;
+            if (start > capacity)
+                throw ScriptError ("Buffer overflow");
+
+            oldTimetableIndex = index;
+
+            // The JS renderer preallocates ~50x what it ends up using; grow on demand instead.
+            const auto end = std::min<int64_t> (start + 5, capacity);
+            if (end > static_cast<int64_t> (buffer.size()))
+                buffer.resize (static_cast<size_t> (end), 0);
+
+            for (auto k = start; k < end; ++k)
+                buffer[static_cast<size_t> (k)] = static_cast<uint8_t> (values[static_cast<size_t> (k - start)] & 0xff);
+
+            // bufferPos never moves backwards, so everything before start is final.
+            if (listener != nullptr && start - emitted >= static_cast<int64_t> (SamEngine::streamChunkBytes))
+                emitUpTo (start);
+        }
+
+        void finish()
+        {
+            buffer.resize (static_cast<size_t> (std::min<int64_t> (bufferPos / 50, capacity)), 0);
+            if (listener != nullptr)
+                emitUpTo (static_cast<int64_t> (buffer.size()));
+        }
+
+    private:
+        void emitUpTo (int64_t end)
+        {
+            end = std::min (end, static_cast<int64_t> (buffer.size()));
+            if (end <= emitted)
+                return;
+
+            if (! (*listener) (buffer.data() + emitted, static_cast<size_t> (end - emitted)))
+                throw ScriptError ("Render cancelled");
+
+            emitted = end;
+        }
+
+        const SamEngine::ChunkCallback* listener = nullptr;
+        std::vector<uint8_t>& buffer;
+        int64_t emitted = 0;
+        int64_t capacity = 0;
+        int64_t bufferPos = 0;
+        int oldTimetableIndex = 0;
+    };
+
+    struct Frames
+    {
+        FrameTable pitches;
+        std::array<FrameTable, 3> frequency;
+        std::array<FrameTable, 3> amplitude;
+        FrameTable consonantFlags;
+
+        void clear()
+        {
+            pitches.clear();
+            consonantFlags.clear();
+            for (size_t i = 0; i < 3; ++i)
+            {
+                frequency[i].clear();
+                amplitude[i].clear();
+            }
+        }
+    };
+
+    class Renderer
+    {
+    public:
+        Renderer (const SamEngine::Settings& settings, const SamEngine::ChunkCallback* listenerIn)
+            : listener (listenerIn),
+              pitch (settings.pitch & 0xff),
+              mouth (settings.mouth & 0xff),
+              throat (settings.throat & 0xff),
+              speed ((settings.speed != 0 ? settings.speed : 72) & 0xff),
+              singMode (settings.singMode)
+        {
+        }
+
+        // frames is working space; the PCM replaces the contents of pcm.
+        void render (const std::vector<Phoneme>& phonemes, Frames& frames, std::vector<uint8_t>& pcm)
+        {
+            const auto formants = setMouthThroat();
+            createFrames (phonemes, formants, frames);
+            const auto frameCount = createTransitions (frames, phonemes);
+
+            if (! singMode)
+            {
+                // Subtract half of F1 from the pitch to get the pitch contour.
+                for (int i = 0; i < frames.pitches.length(); ++i)
+                    frames.pitches.set (i, frames.pitches.get (i) - (toInt32 (frames.frequency[0].get (i)) >> 1));
+            }
+
+            static constexpr int amplitudeRescale[] = { 0x00, 0x01, 0x02, 0x02, 0x02, 0x03, 0x03, 0x04, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0B, 0x0D, 0x0F };
+            for (auto i = frames.amplitude[0].length() - 1; i >= 0; --i)
+            {
+                for (auto& table : frames.amplitude)
+                {
+                    const auto value = table.get (i);
+                    const auto valid = value >= 0.0 && value < static_cast<double> (std::size (amplitudeRescale)) && value == std::floor (value);
+                    table.set (i, valid ? static_cast<double> (amplitudeRescale[static_cast<int> (value)]) : undefinedValue());
+                }
+            }
+
+            double totalLength = 0.0;
+            for (const auto& p : phonemes)
+                totalLength += p.length;
+
+            OutputBuffer output (toInt32 (176.4 * totalLength * speed), pcm, listener);
+            processFrames (output, frameCount, frames);
+            output.finish();
+        }
+
+    private:
+        using FormantTable = std::array<std::array<int, 80>, 3>;
+
+        FormantTable setMouthThroat() const
+        {
+            auto trans = [] (int factor, int initialFrequency)
+            {
+                return (((factor * initialFrequency) >> 8) & 0xff) << 1;
+            };
+
+            FormantTable table {};
+            for (size_t i = 0; i < table[0].size(); ++i)
+            {
+                table[0][i] = classicFrequencyData[i] & 0xff;
+                table[1][i] = (classicFrequencyData[i] >> 8) & 0xff;
+                table[2][i] = (classicFrequencyData[i] >> 16) & 0xff;
+            }
+
+            for (size_t pos = 5; pos < 54; pos = (pos == 29 ? 48 : pos + 1))
+            {
+                table[0][pos] = trans (mouth, table[0][pos]);
+                table[1][pos] = trans (throat, table[1][pos]);
+            }
+
+            return table;
+        }
+
+        // Ramps the pitch up or down over the 30 frames before a sentence end.
+        static void addInflection (int inflection, int pos, FrameTable& pitches)
+        {
+            const auto end = pos;
+            pos = pos < 30 ? 0 : pos - 30;
+
+            double a = 0.0;
+            while ((a = pitches.get (pos)) == 127.0)
+                ++pos;
+
+            while (pos != end)
+            {
+                a += inflection;
+                pitches.set (pos, toInt32 (a) & 0xff);
+                while (++pos != end && pitches.get (pos) == 255.0) {}
+            }
+        }
+
+        void createFrames (const std::vector<Phoneme>& phonemes, const FormantTable& formants, Frames& frames) const
+        {
+            auto lookup = [] (const auto& table, int index, double fallback)
+            {
+                return (index >= 0 && index < static_cast<int> (std::size (table))) ? static_cast<double> (table[static_cast<size_t> (index)]) : fallback;
+            };
+
+            frames.clear();
+            int x = 0;
+
+            for (const auto& p : phonemes)
+            {
+                if (p.index == phonemePeriod)
+                    addInflection (1, x, frames.pitches);
+                else if (p.index == phonemeQuestion)
+                    addInflection (255, x, frames.pitches);
+
+                const auto stressOffset = lookup (stressPitchOffsets, p.stress, undefinedValue());
+                const auto amplitude = toInt32 (lookup (amplitudeData, p.index, 0.0));
+                const auto framePitch = static_cast<double> (toInt32 (pitch + stressOffset) & 0xff);
+
+                for (auto remaining = p.length; remaining > 0; --remaining)
+                {
+                    for (size_t formant = 0; formant < 3; ++formant)
+                        frames.frequency[formant].set (x, lookup (formants[formant], p.index, undefinedValue()));
+
+                    frames.amplitude[0].set (x, amplitude & 0xff);
+                    frames.amplitude[1].set (x, (amplitude >> 8) & 0xff);
+                    frames.amplitude[2].set (x, (amplitude >> 16) & 0xff);
+                    frames.consonantFlags.set (x, lookup (sampledConsonantFlags, p.index, undefinedValue()));
+                    frames.pitches.set (x, framePitch);
+                    ++x;
+                }
+            }
+        }
+
+        static void interpolate (int width, FrameTable& table, int frame, double change)
+        {
+            if (width <= 1)
+                return;
+
+            const auto sign = change < 0.0;
+            const auto remainder = std::fmod (std::abs (change), static_cast<double> (width));
+            const auto div = toInt32 (change / width);
+            double error = 0.0;
+
+            for (auto pos = width - 1; pos > 0; --pos)
+            {
+                auto value = table.get (frame) + div;
+                error += remainder;
+                if (error >= width)
+                {
+                    error -= width;
+                    if (sign)
+                        value -= 1.0;
+                    else if (value != 0.0 && ! std::isnan (value))
+                        value += 1.0;
+                }
+
+                table.set (++frame, value);
+            }
+        }
+
+        // Linear transitions between neighbouring phonemes; see CreateTransitions in samjs.
+        static int createTransitions (Frames& frames, const std::vector<Phoneme>& phonemes)
+        {
+            if (phonemes.empty())
+                throw ScriptError ("Cannot read properties of undefined (reading '1')");
+
+            std::array<FrameTable*, 7> tables { &frames.pitches,
+                                                &frames.frequency[0], &frames.frequency[1], &frames.frequency[2],
+                                                &frames.amplitude[0], &frames.amplitude[1], &frames.amplitude[2] };
+            int boundary = 0;
+
+            for (size_t pos = 0; pos + 1 < phonemes.size(); ++pos)
+            {
+                const auto phoneme = phonemes[pos].index;
+                const auto nextPhoneme = phonemes[pos + 1].index;
+                const auto rank = blendRank[phoneme];
+                const auto nextRank = blendRank[nextPhoneme];
+
+                int outBlendFrames = 0;
+                int inBlendFrames = 0;
+                if (rank == nextRank)
+                {
+                    outBlendFrames = outBlendLength[phoneme];
+                    inBlendFrames = outBlendLength[nextPhoneme];
+                }
+                else if (rank < nextRank)
+                {
+                    outBlendFrames = inBlendLength[nextPhoneme];
+                    inBlendFrames = outBlendLength[nextPhoneme];
+                }
+                else
+                {
+                    outBlendFrames = outBlendLength[phoneme];
+                    inBlendFrames = inBlendLength[phoneme];
+                }
+
+                boundary += phonemes[pos].length;
+                const auto transEnd = boundary + inBlendFrames;
+                const auto transStart = boundary - outBlendFrames;
+                const auto transLength = outBlendFrames + inBlendFrames;
+
+                if (((transLength - 2) & 128) != 0)
+                    continue;
+
+                const auto curWidth = phonemes[pos].length >> 1;
+                const auto nextWidth = phonemes[pos + 1].length >> 1;
+                const auto pitchChange = frames.pitches.get (boundary + nextWidth) - frames.pitches.get (boundary - curWidth);
+                interpolate (curWidth + nextWidth, frames.pitches, transStart, pitchChange);
+
+                for (size_t table = 1; table < tables.size(); ++table)
+                {
+                    const auto change = tables[table]->get (transEnd) - tables[table]->get (transStart);
+                    interpolate (transLength, *tables[table], transStart, change);
+                }
+            }
+
+            return boundary + phonemes.back().length;
+        }
+
+        static int renderSample (OutputBuffer& output, int lastSampleOffset, double consonantFlag, double samplePitch)
+        {
+            const auto flag = toInt32 (consonantFlag);
+            const auto kind = (flag & 7) - 1;
+            const auto samplePage = (kind * 256) & 0xffff;
+            auto off = flag & 248;
+
+            auto renderBits = [&] (int index1, int value1, int index0, int value0)
+            {
+                const auto tableIndex = samplePage + off;
+                auto sample = tableIndex < static_cast<int> (std::size (sampleTable)) ? sampleTable[tableIndex] : 0;
+                for (int bit = 8; bit > 0; --bit)
+                {
+                    if ((sample & 128) != 0)
+                        output.write (index1, value1);
+                    else
+                        output.write (index0, value0);
+                    sample <<= 1;
+                }
+            };
+
+            if (off == 0)
+            {
+                // Voiced sample: one bit pattern per step, for (pitch >> 4) ^ 255 steps.
+                auto phase = (toInt32 (samplePitch) >> 4) ^ 255;
+                off = lastSampleOffset & 0xff;
+                do
+                {
+                    renderBits (3, 26, 4, 6);
+                    off = (off + 1) & 0xff;
+                } while ((++phase & 0xff) != 0);
+                return off;
+            }
+
+            off ^= 255;
+            const auto value0 = (kind >= 0 && kind < static_cast<int> (std::size (sampledConsonantValues))) ? sampledConsonantValues[kind] & 0xff : 0;
+            do
+            {
+                renderBits (2, 5, 1, value0);
+            } while ((++off & 0xff) != 0);
+            return lastSampleOffset;
+        }
+
+        // SAM generates formants directly with two sines and a rectangle wave, resetting
+        // their phases at the start of every glottal pulse.
+        void processFrames (OutputBuffer& output, int frameCount, const Frames& frames) const
+        {
+            auto speedCounter = speed;
+            double phase1 = 0.0;
+            double phase2 = 0.0;
+            double phase3 = 0.0;
+            int lastSampleOffset = 0;
+            int pos = 0;
+            auto glottalPulse = frames.pitches.get (0);
+            auto mem38 = toInt32 (glottalPulse * 0.75);
+
+            while (frameCount != 0)
+            {
+                const auto flags = frames.consonantFlags.get (pos);
+
+                if ((toInt32 (flags) & 248) != 0)
+                {
+                    lastSampleOffset = renderSample (output, lastSampleOffset, flags, frames.pitches.get (pos & 0xff));
+                    pos += 2;
+                    frameCount -= 2;
+                    speedCounter = speed;
+                }
+                else
+                {
+                    std::array<int, 5> block {};
+                    auto p1 = phase1 * 256.0;
+                    auto p2 = phase2 * 256.0;
+                    auto p3 = phase3 * 256.0;
+                    const auto a1 = toInt32 (frames.amplitude[0].get (pos)) & 0x0f;
+                    const auto a2 = toInt32 (frames.amplitude[1].get (pos)) & 0x0f;
+                    const auto a3 = toInt32 (frames.amplitude[2].get (pos)) & 0x0f;
+                    const auto f1 = frames.frequency[0].get (pos) * 256.0 / 4.0;
+                    const auto f2 = frames.frequency[1].get (pos) * 256.0 / 4.0;
+                    const auto f3 = frames.frequency[2].get (pos) * 256.0 / 4.0;
+
+                    for (auto& sample : block)
+                    {
+                        const auto sin1 = sineTable[0xff & (toInt32 (p1) >> 8)] * a1;
+                        const auto sin2 = sineTable[0xff & (toInt32 (p2) >> 8)] * a2;
+                        const auto rect = ((0xff & (toInt32 (p3) >> 8)) < 129 ? -0x70 : 0x70) * a3;
+                        sample = toInt32 (static_cast<double> (sin1 + sin2 + rect) / 32.0 + 128.0);
+                        p1 += f1;
+                        p2 += f2;
+                        p3 += f3;
+                    }
+
+                    output.writeBlock (0, block);
+
+                    if (--speedCounter == 0)
+                    {
+                        ++pos;
+                        if (--frameCount == 0)
+                            return;
+                        speedCounter = speed;
+                    }
+
+                    glottalPulse -= 1.0;
+                    if (glottalPulse != 0.0)
+                    {
+                        --mem38;
+                        if (mem38 != 0 || flags == 0.0)
+                        {
+                            phase1 += frames.frequency[0].get (pos);
+                            phase2 += frames.frequency[1].get (pos);
+                            phase3 += frames.frequency[2].get (pos);
+                            continue;
+                        }
+
+                        lastSampleOffset = renderSample (output, lastSampleOffset, flags, frames.pitches.get (pos & 0xff));
+                    }
+                }
+
+                glottalPulse = frames.pitches.get (pos);
+                mem38 = toInt32 (glottalPulse * 0.75);
+                phase1 = 0.0;
+                phase2 = 0.0;
+                phase3 = 0.0;
+            }
+        }
+
+        const SamEngine::ChunkCallback* listener;
+        int pitch;
+        int mouth;
+        int throat;
+        int speed;
+        bool singMode;
+    };
+
+    // Working storage a render thread keeps between renders, so once it has rendered a
+    // phrase as long as the current one it no longer touches the heap.
+    struct Scratch
+    {
+        std::vector<char32_t> codePoints;
+        std::string text;
+        std::string reciterText;
+        std::string phonemeText;
+        PhonemeParser parser;
+        std::vector<Phoneme> phonemes;
+        Frames frames;
+    };
+
+    Scratch& getScratch()
+    {
+        thread_local Scratch scratch;
+        return scratch;
+    }
+
+    void renderPhonemes (const std::string& phonemes, const SamEngine::Settings& settings,
+                         const SamEngine::ChunkCallback* listener, std::vector<uint8_t>& pcm)
+    {
+        pcm.clear();
+        if (phonemes.empty())
+            return;
+
+        auto& scratch = getScratch();
+        scratch.parser.parse (phonemes, scratch.phonemes);
+        Renderer renderer (settings, listener);
+        renderer.render (scratch.phonemes, scratch.frames, pcm);
+    }
+}
+
+//==============================================================================
+SamEngine::Result SamEngine::render (const std::string& utf8Text, const Settings& settings)
+{
+    return render (utf8Text, settings, nullptr);
+}
+
+SamEngine::Result SamEngine::render (const std::string& utf8Text, const Settings& settings, const ChunkCallback& onChunk)
+{
+    Result result;
+    result.error = renderInto (utf8Text, settings, onChunk, result.pcm);
+    return result;
+}
+
+std::string SamEngine::renderInto (const std::string& utf8Text, const Settings& settings, const ChunkCallback& onChunk,
+                                   std::vector<uint8_t>& pcm)
+{
+    pcm.clear();
+
+    size_t streamedBytes = 0;
+    const ChunkCallback countingListener = [&] (const uint8_t* chunk, size_t numBytes)
+    {
+        streamedBytes += numBytes;
+        return onChunk (chunk, numBytes);
+    };
+    const auto* listener = onChunk != nullptr ? &countingListener : nullptr;
+
+    auto& scratch = getScratch();
+    auto& text = scratch.text;
+    toScriptText (utf8Text, scratch.codePoints, text);
+    if (text.empty())
+        return "No text to render";
+
+    auto clamped = settings;
+    clamped.speed = std::clamp (clamped.speed, 1, 255);
+    clamped.pitch = std::clamp (clamped.pitch, 0, 255);
+    clamped.mouth = std::clamp (clamped.mouth, 0, 255);
+    clamped.throat = std::clamp (clamped.throat, 0, 255);
+
+    try
+    {
+        // Like sam_bridge.js: phonetic input that fails to parse is retried as English.
+        if (clamped.phoneticInput)
+        {
+            try
+            {
+                renderPhonemes (text, clamped, listener, pcm);
+            }
+            catch (const ScriptError&)
+            {
+                if (streamedBytes > 0)
+                    throw;
+
+                pcm.clear();
+            }
+        }
+
+        if (pcm.empty() && Reciter::textToPhonemes (text, scratch.reciterText, scratch.phonemeText))
+            renderPhonemes (scratch.phonemeText, clamped, listener, pcm);
+
+        if (pcm.empty())
+            throw ScriptError ("SAM produced no audio");
+    }
+    catch (const ScriptError& e)
+    {
+        pcm.clear();
+        return e.what();
+    }
+
+    return {};
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// In-process port of the classic SAM pipeline from third_party/samjs.common.js
+// (reciter, parser and renderer). The output is byte-for-byte what sam_bridge.js
+// writes for the classic backend, including its phonetic-input fallback.
+class SamEngine
+{
+public:
+    struct Settings
+    {
+        int speed = 72;
+        int pitch = 64;
+        int mouth = 128;
+        int throat = 128;
+        bool singMode = false;
+        bool phoneticInput = false;
+    };
+
+    struct Result
+    {
+        std::vector<uint8_t> pcm;
+        std::string error;
+    };
+
+    // Receives each newly finished span of PCM while a render is in progress.
+    // Returning false cancels the render.
+    using ChunkCallback = std::function<bool (const uint8_t* pcm, size_t numBytes)>;
+
+    // Fixed, like the Node backend's. Phrases are cached and packed at this rate and
+    // Pcm8Interpolator band-limits them to the host rate as they play; running the
+    // renderer's clock at the host rate instead leaves images of the 22050 Hz steps.
+    static constexpr double outputSampleRate = 22050.0;
+
+    // Roughly how much finished audio is collected before a ChunkCallback fires.
+    static constexpr size_t streamChunkBytes = 512;
+
+    // Renders UTF-8 text to unsigned 8-bit mono PCM at outputSampleRate.
+    // On failure pcm is empty and error describes what went wrong.
+    static Result render (const std::string& utf8Text, const Settings& settings);
+
+    // As above, but also hands the audio to onChunk as the renderer produces it. The
+    // chunks concatenate to Result::pcm. Once a chunk has been delivered, a failure is
+    // reported as an error rather than retried through the phonetic-input fallback.
+    static Result render (const std::string& utf8Text, const Settings& settings, const ChunkCallback& onChunk);
+
+    // As above, but renders into pcm, reusing its capacity, and returns the error, which
+    // is empty on success. The engine's working storage is kept per thread, so a thread
+    // that keeps rendering phrases of similar length stops allocating.
+    static std::string renderInto (const std::string& utf8Text, const Settings& settings, const ChunkCallback& onChunk,
+                                   std::vector<uint8_t>& pcm);
+};
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Keeps a single `sam_bridge.js --server` process alive between phrases so the Node
+// backends skip process start-up and module loading. juce::ChildProcess only exposes
+// the child's stdout, so requests and PCM travel over a loopback socket whose port
+// the worker announces on stdout. Not thread-safe: use it from one render thread.
+// Request frames are built in a buffer kept between phrases, and the PCM lands straight
+// in the caller's buffer, so a steady stream of phrases reuses the same memory.
+class SamNodeWorker
+{
+public:
+    struct Request
+    {
+        juce::String text;
+        int speed = 72;
+        int pitch = 64;
+        int mouth = 128;
+        int throat = 128;
+        bool singMode = false;
+        bool phoneticInput = false;
+        bool betterBackend = false;
+    };
+
+    SamNodeWorker() = default;
+
+    ~SamNodeWorker()
+    {
+        stop();
+    }
+
+    // Replaces pcm with the rendered audio. Returns an empty string on success, otherwise
+    // what went wrong, in which case pcm holds nothing useful.
+    juce::String render (const juce::String& nodePath, const juce::File& scriptPath, const Request& request, int timeoutMs,
+                         std::vector<uint8_t>& pcm)
+    {
+        juce::String error;
+
+        // A worker that died since the previous phrase gets one restart before giving up.
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            if (! ensureRunning (nodePath, scriptPath, error))
+                return error;
+
+            const auto outcome = exchange (request, timeoutMs, pcm, error);
+            if (outcome == Outcome::ok || outcome == Outcome::scriptError)
+                return error;
+
+            stop();
+            if (outcome == Outcome::timedOut)
+                return "SAM render timeout";
+
+            error = "SAM worker exited";
+        }
+
+        return error;
+    }
+
+    void stop()
+    {
+        socket.reset();
+        if (process != nullptr)
+        {
+            process->kill();
+            process.reset();
+        }
+        runningNodePath.clear();
+    }
+
+private:
+    enum class Outcome
+    {
+        ok,
+        scriptError,
+        failed,
+        timedOut
+    };
+
+    bool ensureRunning (const juce::String& nodePath, const juce::File& scriptPath, juce::String& error)
+    {
+        if (socket != nullptr && process != nullptr && process->isRunning() && nodePath == runningNodePath)
+            return true;
+
+        stop();
+
+        juce::StringArray args;
+        args.add (nodePath);
+        args.add (scriptPath.getFullPathName());
+        args.add ("--server");
+
+        process = std::make_unique<juce::ChildProcess>();
+        if (! process->start (args, juce::ChildProcess::wantStdOut))
+        {
+            process.reset();
+            error = "Failed to launch Node: " + nodePath + " (set SAM_NODE_PATH or install Node.js)";
+            return false;
+        }
+
+        const auto port = readAnnouncedPort();
+        if (port <= 0)
+        {
+            stop();
+            error = "SAM worker failed to start";
+            return false;
+        }
+
+        socket = std::make_unique<juce::StreamingSocket>();
+        if (! socket->connect ("127.0.0.1", port, 2000))
+        {
+            stop();
+            error = "SAM worker connection failed";
+            return false;
+        }
+
+        runningNodePath = nodePath;
+        return true;
+    }
+
+    // readProcessOutput() blocks until the child writes or exits, so the line is read on
+    // a helper thread. If no port arrives in time the child is killed, which closes its
+    // stdout and lets the helper return; the next phrase starts a fresh worker.
+    int readAnnouncedPort()
+    {
+        juce::String line;
+        juce::WaitableEvent lineRead;
+        std::thread reader ([this, &line, &lineRead]
+        {
+            char c = 0;
+            while (line.length() < 64 && process->readProcessOutput (&c, 1) == 1 && c != '\n')
+                line << c;
+
+            lineRead.signal();
+        });
+
+        const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32> (startupTimeoutMs);
+        while (! lineRead.wait (50))
+        {
+            if (juce::Time::getMillisecondCounter() >= deadline || juce::Thread::currentThreadShouldExit())
+            {
+                process->kill();
+                break;
+            }
+        }
+
+        reader.join();
+
+        if (! line.startsWith ("SAM_SERVER_PORT "))
+            return 0;
+
+        return line.fromFirstOccurrenceOf (" ", false, false).getIntValue();
+    }
+
+    Outcome exchange (const Request& request, int timeoutMs, std::vector<uint8_t>& pcm, juce::String& error)
+    {
+        const auto* text = request.text.toRawUTF8();
+        const auto textBytes = request.text.getNumBytesAsUTF8();
+        const uint8_t flags = static_cast<uint8_t> ((request.singMode ? 1 : 0)
+                                                    | (request.phoneticInput ? 2 : 0)
+                                                    | (request.betterBackend ? 4 : 0));
+        const uint8_t header[] =
+        {
+            static_cast<uint8_t> (juce::jlimit (1, 255, request.speed)),
+            static_cast<uint8_t> (juce::jlimit (0, 255, request.pitch)),
+            static_cast<uint8_t> (juce::jlimit (0, 255, request.mouth)),
+            static_cast<uint8_t> (juce::jlimit (0, 255, request.throat)),
+            flags
+        };
+
+        const auto frameSize = static_cast<uint32_t> (sizeof (header) + textBytes);
+        const uint8_t sizeBytes[] = { static_cast<uint8_t> (frameSize), static_cast<uint8_t> (frameSize >> 8),
+                                      static_cast<uint8_t> (frameSize >> 16), static_cast<uint8_t> (frameSize >> 24) };
+        frame.clear();
+        frame.insert (frame.end(), sizeBytes, sizeBytes + sizeof (sizeBytes));
+        frame.insert (frame.end(), header, header + sizeof (header));
+        frame.insert (frame.end(), text, text + textBytes);
+
+        if (socket->write (frame.data(), static_cast<int> (frame.size())) != static_cast<int> (frame.size()))
+            return Outcome::failed;
+
+        const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32> (timeoutMs);
+
+        uint8_t responseHeader[5] {};
+        if (const auto outcome = readExactly (responseHeader, sizeof (responseHeader), deadline); outcome != Outcome::ok)
+            return outcome;
+
+        const auto payloadSize = static_cast<size_t> (responseHeader[1])
+                               | (static_cast<size_t> (responseHeader[2]) << 8)
+                               | (static_cast<size_t> (responseHeader[3]) << 16)
+                               | (static_cast<size_t> (responseHeader[4]) << 24);
+        if (payloadSize > maxPayloadBytes)
+            return Outcome::failed;
+
+        pcm.resize (payloadSize);
+        if (payloadSize > 0)
+            if (const auto outcome = readExactly (pcm.data(), payloadSize, deadline); outcome != Outcome::ok)
+                return outcome;
+
+        if (responseHeader[0] != 0)
+        {
+            const auto message = juce::String::fromUTF8 (reinterpret_cast<const char*> (pcm.data()), static_cast<int> (payloadSize));
+            error = "SAM error: " + message.upToFirstOccurrenceOf ("\n", false, false);
+            return Outcome::scriptError;
+        }
+
+        return Outcome::ok;
+    }
+
+    Outcome readExactly (void* dest, size_t numBytes, juce::uint32 deadline)
+    {
+        auto* out = static_cast<char*> (dest);
+        size_t received = 0;
+
+        while (received < numBytes)
+        {
+            const auto now = juce::Time::getMillisecondCounter();
+            if (now >= deadline || juce::Thread::currentThreadShouldExit())
+                return Outcome::timedOut;
+
+            const auto ready = socket->waitUntilReady (true, static_cast<int> (juce::jmin<juce::uint32> (deadline - now, 100)));
+            if (ready < 0)
+                return Outcome::failed;
+            if (ready == 0)
+                continue;
+
+            const auto bytesRead = socket->read (out + received, static_cast<int> (numBytes - received), false);
+            if (bytesRead <= 0)
+                return Outcome::failed;
+
+            received += static_cast<size_t> (bytesRead);
+        }
+
+        return Outcome::ok;
+    }
+
+    static constexpr size_t maxPayloadBytes = 64 * 1024 * 1024;
+    static constexpr int startupTimeoutMs = 10000;
+
+    std::unique_ptr<juce::ChildProcess> process;
+    std::unique_ptr<juce::StreamingSocket> socket;
+    juce::String runningNodePath;
+    std::vector<uint8_t> frame;
+
+    JUCE_DECLARE_NON_COPYABLE (SamNodeWorker)
+};
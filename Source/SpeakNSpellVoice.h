@@ -1,11 +1,24 @@
 #pragma once
 
 #include <juce_audio_utils/juce_audio_utils.h>
+#include "SamEngine.h"
+#include "SamNodeWorker.h"
+#include "RenderCache.h"
+#include "PhrasePackCache.h"
+#include "PcmBufferPool.h"
+#include "PolyphaseResampler.h"
+#include "Pcm8Interpolator.h"
+#include "EffectKernels.h"
+#include "QuadratureOscillator.h"
+#include "FrequencyShifter.h"
+#include "TripleBuffer.h"
+#include "NoteVoicePool.h"
 #include <atomic>
 #include <array>
 #include <cmath>
 #include <cstring>
-#include <optional>
+#include <limits>
+#include <utility>
 #include <vector>
 
 class SpeakNSpellVoice
@@ -26,6 +39,8 @@ public:
         bool singMode = false;
         bool phoneticInput = false;
         Backend backend = Backend::classicSam;
+
+        bool operator== (const Parameters&) const = default;
     };
 
     struct RealtimeControls
@@ -41,8 +56,31 @@ public:
         float freqShift = 0.0f;
         float repitchJitter = 0.0f;
         float mutation = 0.0f;
+
+        bool operator== (const RealtimeControls&) const = default;
     };
 
+    // Phrases rendered to disk are shared with every instance that uses the same pack.
+    explicit SpeakNSpellVoice (juce::File phrasePackFile = PhrasePackCache::getDefaultFile())
+        : phrasePack (std::move (phrasePackFile))
+    {
+        for (int slot = 0; slot < numPhraseSlots; ++slot)
+            freePhraseSlots.push (slot);
+
+        for (int source = 0; source < numNoteSources; ++source)
+            freeNoteSources.push (source);
+
+        prepareInterpolators();
+
+        renderWorker = std::make_unique<RenderWorker> (*this);
+        renderWorker->startThread();
+    }
+
+    ~SpeakNSpellVoice()
+    {
+        renderWorker->stopThread (4000);
+    }
+
     static int getNumFactoryPresets()
     {
         return 10;
@@ -121,158 +159,1267 @@ public:
         }
     }
 
-    void setSampleRate (double newSampleRate)
-    {
-        sampleRate = juce::jmax (8000.0, newSampleRate);
+    void setSampleRate (double newSampleRate)
+    {
+        sampleRate = juce::jmax (8000.0, newSampleRate);
+        notePool.setSampleRate (sampleRate);
+        prepareInterpolators();
+    }
+
+    // Safe to call from any thread but the audio thread: the job is copied into a fixed
+    // slot and rendered on the worker thread, but text the queue policy drops to make
+    // room is freed by the caller. Text the queue policy turns away is counted in
+    // getQueueCounters(), and shows as queueFull until the next change.
+    void queueText (juce::String text, Parameters params)
+    {
+        text = text.trim();
+        if (text.isEmpty())
+        {
+            status.store (Status::idle);
+            return;
+        }
+
+        status.store (pushRenderJob (text, params, RenderJob::Destination::playback) ? Status::rendering
+                                                                                      : Status::queueFull);
+    }
+
+    // Renders into the caches in the background without playing, so the next trigger
+    // with these parameters starts from memory.
+    void prerenderText (juce::String text, Parameters params)
+    {
+        text = text.trim();
+        if (text.isNotEmpty())
+            pushRenderJob (text, params, RenderJob::Destination::cache);
+    }
+
+    // Renders `text` in the background and, once it is ready, makes it the utterance
+    // that noteOn() plays. Notes already sounding finish with the previous one.
+    void setNoteText (juce::String text, Parameters params)
+    {
+        text = text.trim();
+        if (text.isNotEmpty())
+            pushRenderJob (text, params, RenderJob::Destination::notes);
+    }
+
+    // Audio thread only. Starts the note utterance transposed from middle C, looping
+    // while the note is held if loop-at-end is on. Returns false if no utterance has
+    // been rendered for notes yet.
+    bool noteOn (int note, float velocity)
+    {
+        updateNoteSources();
+        if (currentNoteSource < 0)
+            return false;
+
+        const auto& pcm = *noteSources[static_cast<size_t> (currentNoteSource)];
+        notePool.noteOn (note, velocity, { pcm.data(), pcm.size(), currentNoteSource }, loopAtEnd.load());
+        return true;
+    }
+
+    // Audio thread only.
+    void noteOff (int note)
+    {
+        notePool.noteOff (note);
+    }
+
+    // Audio thread only.
+    void allNotesOff()
+    {
+        notePool.allNotesOff();
+    }
+
+    // Audio thread only. Further note-ons steal once this many notes are sounding.
+    void setNumNoteVoices (int numVoices)
+    {
+        notePool.setVoiceLimit (numVoices);
+    }
+
+    int getNumActiveNotes() const
+    {
+        return numActiveNotes.load();
+    }
+
+    enum class Status
+    {
+        idle,
+        rendering,
+        queued,
+        looping,
+        queueFull,
+        renderFailed,
+        samError,
+        missingFile,
+        nodeError
+    };
+
+    struct StatusCounters
+    {
+        juce::int64 queuedSamples = 0;
+        juce::uint32 renders = 0;
+        juce::uint32 failures = 0;
+        juce::uint32 loops = 0;
+    };
+
+    Status getStatus() const
+    {
+        return status.load();
+    }
+
+    StatusCounters getStatusCounters() const
+    {
+        StatusCounters counters;
+        counters.queuedSamples = lastQueuedSamples.load();
+        counters.renders = rendersQueued.load();
+        counters.failures = renderFailures.load();
+        counters.loops = loopsPlayed.load();
+        return counters;
+    }
+
+    // The audio and worker threads only store the state and bump counters; the text is
+    // put together here, on whichever thread polls for it.
+    juce::String getStatusText() const
+    {
+        const auto counters = getStatusCounters();
+        juce::String text;
+
+        switch (status.load())
+        {
+            case Status::idle:           text = "Idle"; break;
+            case Status::rendering:      text = "Rendering SAM..."; break;
+            case Status::queued:         text << "Queued " << counters.queuedSamples << " samples"; break;
+            case Status::looping:        text = "Looping"; break;
+            case Status::queueFull:      text = "Render queue full"; break;
+            case Status::renderFailed:   text = "SAM render failed"; break;
+            case Status::samError:       text = "SAM error: " + getFailureDetail(); break;
+            case Status::missingFile:    text = "Missing " + getFailureDetail(); break;
+            case Status::nodeError:      text = getFailureDetail(); break;
+            default:                     break;
+        }
+
+        const auto latencyMs = lastTriggerLatencyMs.load();
+        if (latencyMs >= 0.0)
+            text << " | first audio " << juce::roundToInt (latencyMs) << " ms";
+
+        const auto depthSeconds = getQueueDepthSeconds();
+        if (depthSeconds > 0.0)
+            text << " | queue " << juce::String (depthSeconds, 1) << " s";
+
+        if (counters.renders + counters.failures + counters.loops > 0)
+            text << " | " << static_cast<int> (counters.renders) << " rendered, "
+                 << static_cast<int> (counters.failures) << " failed, "
+                 << static_cast<int> (counters.loops) << " loops";
+        return text;
+    }
+
+    double getLastTriggerLatencyMs() const
+    {
+        return lastTriggerLatencyMs.load();
+    }
+
+    RenderCache::Stats getCacheStats() const
+    {
+        return renderCache.getStats();
+    }
+
+    PhrasePackCache::Stats getDiskCacheStats() const
+    {
+        return phrasePack.getStats();
+    }
+
+    PcmBufferPool::Stats getBufferPoolStats() const
+    {
+        return bufferPool.getStats();
+    }
+
+    juce::String getCacheStatusText() const
+    {
+        const auto stats = renderCache.getStats();
+        const auto disk = phrasePack.getStats();
+        const auto pool = bufferPool.getStats();
+        return "Cache " + juce::String (static_cast<juce::int64> (stats.hits)) + " hits / "
+             + juce::String (static_cast<juce::int64> (stats.misses)) + " misses / "
+             + juce::String (static_cast<juce::int64> (stats.evictions)) + " evictions ("
+             + juce::String (static_cast<juce::int64> (stats.bytes / 1024)) + " KB) | Disk "
+             + juce::String (static_cast<juce::int64> (disk.hits)) + " hits / "
+             + juce::String (static_cast<juce::int64> (disk.misses)) + " misses | Buffers "
+             + juce::String (static_cast<juce::int64> (pool.reuses)) + " reused / "
+             + juce::String (static_cast<juce::int64> (pool.allocations)) + " allocated ("
+             + juce::String (static_cast<juce::int64> (pool.bytes / 1024)) + " KB)";
+    }
+
+    void setCacheBudgetBytes (size_t budgetBytes)
+    {
+        renderCache.setBudgetBytes (budgetBytes);
+    }
+
+    // Phrases are resampled as they play, so this applies from the next block.
+    void setResampleQuality (PolyphaseResampler::Quality quality)
+    {
+        resampleQuality.store (static_cast<int> (quality));
+    }
+
+    PolyphaseResampler::Quality getResampleQuality() const
+    {
+        return static_cast<PolyphaseResampler::Quality> (resampleQuality.load());
+    }
+
+    enum class FrequencyShiftMode
+    {
+        singleSideband,     // every partial moves up by the shift frequency
+        legacyRingBlend     // the original dry + ring-modulated mix
+    };
+
+    void setFrequencyShiftMode (FrequencyShiftMode mode)
+    {
+        frequencyShiftMode.store (static_cast<int> (mode));
+    }
+
+    FrequencyShiftMode getFrequencyShiftMode() const
+    {
+        return static_cast<FrequencyShiftMode> (frequencyShiftMode.load());
+    }
+
+    // What queueText() does with new text once the queue is over one of its limits.
+    enum class QueuePolicy
+    {
+        dropNewest,         // refuse the new text
+        dropOldest,         // forget the oldest text that hasn't started rendering
+        coalesceLatest,     // the new text replaces everything that hasn't started rendering
+        interrupt           // cut off what is playing and queued, and speak the new text next
+    };
+
+    // The worker holds back playback renders while more than maxQueuedSeconds of audio
+    // is waiting to play, so text piles up as pending jobs until the policy steps in.
+    struct QueueLimits
+    {
+        double maxQueuedSeconds = 10.0;
+        int maxPendingJobs = 4;
+        QueuePolicy policy = QueuePolicy::dropOldest;
+    };
+
+    struct QueueCounters
+    {
+        juce::uint32 dropped = 0;
+        juce::uint32 coalesced = 0;
+        juce::uint32 interrupts = 0;
+    };
+
+    void setQueueLimits (QueueLimits limits)
+    {
+        maxQueuedSeconds.store (juce::jlimit (0.5, 600.0, limits.maxQueuedSeconds));
+        maxPendingJobs.store (juce::jlimit (1, maxPendingPlaybackJobs, limits.maxPendingJobs));
+        queuePolicy.store (static_cast<int> (limits.policy));
+    }
+
+    QueueLimits getQueueLimits() const
+    {
+        QueueLimits limits;
+        limits.maxQueuedSeconds = maxQueuedSeconds.load();
+        limits.maxPendingJobs = maxPendingJobs.load();
+        limits.policy = static_cast<QueuePolicy> (queuePolicy.load());
+        return limits;
+    }
+
+    QueueCounters getQueueCounters() const
+    {
+        QueueCounters counters;
+        counters.dropped = droppedMessages.load();
+        counters.coalesced = coalescedMessages.load();
+        counters.interrupts = queueInterrupts.load();
+        return counters;
+    }
+
+    // Empty until the queue policy has turned text away.
+    juce::String getQueueStatusText() const
+    {
+        const auto counters = getQueueCounters();
+        if (counters.dropped + counters.coalesced + counters.interrupts == 0)
+            return {};
+
+        juce::String text;
+        text << static_cast<int> (counters.dropped) << " dropped, "
+             << static_cast<int> (counters.coalesced) << " coalesced, "
+             << static_cast<int> (counters.interrupts) << " interrupts";
+        return text;
+    }
+
+    void render (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    {
+        render (buffer, startSample, numSamples, controlsSnapshot.read());
+    }
+
+    // For hosts that own the controls, e.g. as automatable parameters: `target` is where
+    // the controls should be for this block. While they glide towards it the block is
+    // processed in short steps, so the glide doesn't depend on the host's block size.
+    void render (juce::AudioBuffer<float>& buffer, int startSample, int numSamples, const RealtimeControls& target)
+    {
+        auto* left = buffer.getWritePointer (0, startSample);
+        auto* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer (1, startSample) : nullptr;
+
+        mutationAmount.store (target.mutation);
+        updateNoteSources();
+
+        for (int done = 0; done < numSamples;)
+        {
+            const auto step = controlsSettledAt (target) ? numSamples - done : juce::jmin (numSamples - done, controlSmoothingStep);
+            const auto& controls = smoothControls (target, step);
+            renderPlayback (left + done, step, controls);
+            notePool.render (left + done, step, getPlaybackStep (controls) * getSourceStep(), getInterpolator());
+            processRealtimeEffects (left + done, step, controls);
+            done += step;
+        }
+
+        numActiveNotes.store (notePool.getNumActiveVoices());
+
+        if (right != nullptr)
+            juce::FloatVectorOperations::copy (right, left, numSamples);
+
+        const auto currentSize = currentPhrase >= 0 ? static_cast<double> (phrases[static_cast<size_t> (currentPhrase)].getNumSamples()) : 0.0;
+        currentSamplesLeft.store (static_cast<juce::int64> (juce::jmax (0.0, currentSize - playhead)));
+    }
+
+    // Audio published but not yet played: queued segments plus the rest of the current one.
+    juce::int64 getQueueDepthSamples() const
+    {
+        return juce::jmax<juce::int64> (0, queuedSamples.load() + currentSamplesLeft.load());
+    }
+
+    double getQueueDepthSeconds() const
+    {
+        return static_cast<double> (getQueueDepthSamples()) / SamEngine::outputSampleRate;
+    }
+
+    void setLoopAtEnd (bool shouldLoop)
+    {
+        loopAtEnd.store (shouldLoop);
+    }
+
+    bool getLoopAtEnd() const
+    {
+        return loopAtEnd.load();
+    }
+
+    // Any thread. The audio thread picks the new set up whole at its next block.
+    void setRealtimeControls (RealtimeControls controls)
+    {
+        controls.playbackSpeed = juce::jlimit (0.25f, 4.0f, controls.playbackSpeed);
+        controls.repitchSemitones = juce::jlimit (-24.0f, 24.0f, controls.repitchSemitones);
+        controls.formantWarp = juce::jlimit (0.0f, 1.0f, controls.formantWarp);
+        controls.glitchGate = juce::jlimit (0.0f, 1.0f, controls.glitchGate);
+        controls.bitCrush = juce::jlimit (0.0f, 1.0f, controls.bitCrush);
+        controls.microLoop = juce::jlimit (0.0f, 1.0f, controls.microLoop);
+        controls.spectralTilt = juce::jlimit (0.0f, 1.0f, controls.spectralTilt);
+        controls.ringMod = juce::jlimit (0.0f, 1.0f, controls.ringMod);
+        controls.freqShift = juce::jlimit (0.0f, 1.0f, controls.freqShift);
+        controls.repitchJitter = juce::jlimit (0.0f, 1.0f, controls.repitchJitter);
+        controls.mutation = juce::jlimit (0.0f, 1.0f, controls.mutation);
+
+        mutationAmount.store (controls.mutation);
+
+        const juce::SpinLock::ScopedLockType sl (controlsLock);
+        latestControls = controls;
+        controlsSnapshot.write (controls);
+    }
+
+    // For threads other than the audio thread, which reads the snapshot instead.
+    RealtimeControls getRealtimeControls() const
+    {
+        const juce::SpinLock::ScopedLockType sl (controlsLock);
+        return latestControls;
+    }
+
+    void setCustomNodePath (juce::String path)
+    {
+        path = path.trim();
+        const juce::SpinLock::ScopedLockType sl (nodePathLock);
+        customNodePath = path;
+    }
+
+    juce::String getCustomNodePath() const
+    {
+        const juce::SpinLock::ScopedLockType sl (nodePathLock);
+        return customNodePath;
+    }
+
+private:
+    struct RenderJob
+    {
+        enum class Destination
+        {
+            playback,   // queue for playback as soon as it is rendered
+            cache,      // only warm the caches
+            notes       // warm the caches and hand the phrase to the note voices
+        };
+
+        juce::String text;
+        Parameters params;
+        double requestedAtMs = 0.0;
+        Destination destination = Destination::playback;
+        juce::uint32 sequence = 0;  // numbers playback jobs, so an interrupt can name its cut-off
+    };
+
+    // Pending jobs, oldest first, in a fixed array that the queue policy edits in place.
+    template <int Capacity>
+    struct PendingJobs
+    {
+        bool isEmpty() const { return size == 0; }
+        bool isFull() const  { return size == Capacity; }
+
+        RenderJob& front() { return jobs[0]; }
+
+        void pushBack (RenderJob job)
+        {
+            jassert (! isFull());
+            jobs[static_cast<size_t> (size++)] = std::move (job);
+        }
+
+        RenderJob remove (int index)
+        {
+            auto job = std::move (jobs[static_cast<size_t> (index)]);
+            std::move (jobs.begin() + index + 1, jobs.begin() + size, jobs.begin() + index);
+            jobs[static_cast<size_t> (--size)] = {};
+            return job;
+        }
+
+        void clear()
+        {
+            while (size > 0)
+                jobs[static_cast<size_t> (--size)] = {};
+        }
+
+        int find (RenderJob::Destination destination) const
+        {
+            for (int i = 0; i < size; ++i)
+                if (jobs[static_cast<size_t> (i)].destination == destination)
+                    return i;
+            return -1;
+        }
+
+        std::array<RenderJob, static_cast<size_t> (Capacity)> jobs;
+        int size = 0;
+    };
+
+    static constexpr int maxPendingPlaybackJobs = 8;
+    static constexpr int maxPendingBackgroundJobs = 8;
+
+    // Returns false if the job was turned away: playback text the queue policy refuses,
+    // or a cache job when the cache and note queue is full.
+    bool pushRenderJob (const juce::String& text, const Parameters& params, RenderJob::Destination destination)
+    {
+        RenderJob job;
+        job.text = text;
+        job.params = params;
+        job.requestedAtMs = juce::Time::getMillisecondCounterHiRes();
+        job.destination = destination;
+
+        PendingJobs<maxPendingPlaybackJobs> dropped;
+        {
+            const juce::SpinLock::ScopedLockType sl (jobLock);
+
+            if (destination == RenderJob::Destination::playback)
+            {
+                if (! admitPlaybackJob (dropped))
+                    return false;
+
+                job.sequence = nextPlaybackJob++;
+                playbackJobs.pushBack (std::move (job));
+            }
+            else if (! queueBackgroundJob (std::move (job)))
+            {
+                return false;
+            }
+        }
+
+        renderWorker->notify();
+        return true;
+    }
+
+    // Called with jobLock held. Makes room for one more playback job as the policy says,
+    // or returns false if the policy refuses it. Jobs it drops go into dropped, so their
+    // text is freed after the lock is released.
+    bool admitPlaybackJob (PendingJobs<maxPendingPlaybackJobs>& dropped)
+    {
+        const auto numPending = playbackJobs.size;
+        const auto maxPending = maxPendingJobs.load();
+
+        if (numPending < maxPending && getQueueDepthSeconds() < maxQueuedSeconds.load())
+            return true;
+
+        switch (static_cast<QueuePolicy> (queuePolicy.load()))
+        {
+            case QueuePolicy::dropNewest:
+                droppedMessages.fetch_add (1);
+                return false;
+
+            case QueuePolicy::dropOldest:
+                // Over on queued seconds alone, the new job waits behind the backpressure.
+                while (playbackJobs.size >= maxPending)
+                {
+                    dropped.pushBack (playbackJobs.remove (0));
+                    droppedMessages.fetch_add (1);
+                }
+                return true;
+
+            case QueuePolicy::coalesceLatest:
+                while (! playbackJobs.isEmpty())
+                    dropped.pushBack (playbackJobs.remove (0));
+                coalescedMessages.fetch_add (static_cast<juce::uint32> (numPending));
+                return true;
+
+            case QueuePolicy::interrupt:
+                while (! playbackJobs.isEmpty())
+                    dropped.pushBack (playbackJobs.remove (0));
+                cutPlaybackBefore.store (nextPlaybackJob);
+                droppedMessages.fetch_add (static_cast<juce::uint32> (numPending));
+                queueInterrupts.fetch_add (1);
+                return true;
+
+            default:
+                // Keeps the array in bounds whatever the stored policy holds.
+                if (playbackJobs.isFull())
+                    dropped.pushBack (playbackJobs.remove (0));
+                return true;
+        }
+    }
+
+    // Called with jobLock held. Only the newest note text matters, so it replaces a note
+    // job that hasn't started. Prerendering is best effort and gives way to notes.
+    bool queueBackgroundJob (RenderJob job)
+    {
+        if (job.destination == RenderJob::Destination::notes)
+        {
+            if (const auto pending = backgroundJobs.find (RenderJob::Destination::notes); pending >= 0)
+            {
+                backgroundJobs.jobs[static_cast<size_t> (pending)] = std::move (job);
+                return true;
+            }
+
+            if (backgroundJobs.isFull())
+                backgroundJobs.remove (backgroundJobs.find (RenderJob::Destination::cache));
+        }
+        else if (backgroundJobs.isFull())
+        {
+            return false;
+        }
+
+        backgroundJobs.pushBack (std::move (job));
+        return true;
+    }
+
+    // Sequence numbers wrap, so they are only ever compared by their difference.
+    static bool isEarlier (juce::uint32 a, juce::uint32 b)
+    {
+        return static_cast<juce::int32> (a - b) < 0;
+    }
+
+    // A playback job older than the last interrupt, or a segment rendered for one.
+    bool isInterrupted (juce::uint32 playbackJob) const
+    {
+        return isEarlier (playbackJob, cutPlaybackBefore.load());
+    }
+
+    bool isInterrupted (const RenderJob& job) const
+    {
+        return job.destination == RenderJob::Destination::playback && isInterrupted (job.sequence);
+    }
+
+    bool isQueueOverBudget() const
+    {
+        return getQueueDepthSeconds() >= maxQueuedSeconds.load();
+    }
+
+    // One slot's worth of audio: a span of a shared, immutable buffer of native 8-bit
+    // PCM, followed by gapSamples of silence that is never stored. Positions count native
+    // samples from the start of the span; the interpolator may read a little either side
+    // of it, so a streamed segment's buffer carries that context from its neighbours. A
+    // cached phrase is played straight out of the cache's buffer. A streamed phrase
+    // arrives as several segments in order; the last one has endsPhrase set.
+    struct RenderedPhrase
+    {
+        RenderCache::Samples buffer;
+        size_t start = 0;
+        size_t length = 0;
+        size_t gapSamples = 0;
+        double requestedAtMs = 0.0;
+        juce::uint32 job = 0;
+        bool endsPhrase = true;
+
+        size_t getNumSamples() const { return length + gapSamples; }
+    };
+
+    // Single-producer/single-consumer queue of phrase slot indices.
+    template <int Capacity>
+    struct PhraseSlotFifo
+    {
+        bool push (int slot)
+        {
+            int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+            fifo.prepareToWrite (1, start1, size1, start2, size2);
+            if (size1 == 0)
+                return false;
+
+            slots[static_cast<size_t> (start1)] = slot;
+            fifo.finishedWrite (1);
+            return true;
+        }
+
+        bool pop (int& slot)
+        {
+            int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+            fifo.prepareToRead (1, start1, size1, start2, size2);
+            if (size1 == 0)
+                return false;
+
+            slot = slots[static_cast<size_t> (start1)];
+            fifo.finishedRead (1);
+            return true;
+        }
+
+        juce::AbstractFifo fifo { Capacity + 1 };
+        std::array<int, static_cast<size_t> (Capacity + 1)> slots {};
+    };
+
+    class RenderWorker final : public juce::Thread
+    {
+    public:
+        explicit RenderWorker (SpeakNSpellVoice& ownerIn)
+            : juce::Thread ("SAMRenderWorker"),
+              owner (ownerIn)
+        {
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                owner.reclaimFreeSlots();
+                owner.reclaimNoteSources();
+
+                RenderJob job;
+                if (! owner.popRenderJob (job))
+                {
+                    wait (50);
+                    continue;
+                }
+
+                owner.renderJob (job);
+            }
+        }
+
+    private:
+        SpeakNSpellVoice& owner;
+    };
+
+    // Takes the job requested first out of the two queues. Playback jobs wait while the
+    // queued audio is over budget, or until there are slots for a whole streamed phrase,
+    // so publishing one never blocks the worker; cache and note jobs carry on past them.
+    bool popRenderJob (RenderJob& job)
+    {
+        const juce::SpinLock::ScopedLockType sl (jobLock);
+
+        const auto playbackReady = ! playbackJobs.isEmpty() && ! isQueueOverBudget() && numSpareSlots >= maxSegmentsPerPhrase;
+        if (playbackReady && (backgroundJobs.isEmpty() || playbackJobs.front().requestedAtMs <= backgroundJobs.front().requestedAtMs))
+        {
+            job = playbackJobs.remove (0);
+            return true;
+        }
+
+        if (backgroundJobs.isEmpty())
+            return false;
+
+        job = backgroundJobs.remove (0);
+        return true;
+    }
+
+    // Worker-side state for one streamed phrase: collects engine chunks as they arrive and
+    // publishes them in segments that double in length, so playback can begin after the
+    // first short segment without flooding the slot pool. A phrase may be built from
+    // several sentences, joined with the usual phrase gap. For jobs that don't play, it
+    // only collects.
+    class PhraseStream
+    {
+    public:
+        PhraseStream (SpeakNSpellVoice& ownerIn, const RenderJob& jobIn)
+            : owner (ownerIn),
+              job (jobIn),
+              publishing (jobIn.destination == RenderJob::Destination::playback),
+              output (ownerIn.bufferPool.acquire (typicalPhraseBytes)),
+              nextSegmentSize (static_cast<size_t> (streamFirstSegmentSeconds * SamEngine::outputSampleRate))
+        {
+        }
+
+        bool push (const uint8_t* pcm, size_t numBytes)
+        {
+            const auto gap = sentenceOpen || output->empty() ? size_t { 0 } : getPhraseGapSamples();
+            owner.bufferPool.reserve (output, output->size() + gap + numBytes);
+            output->insert (output->end(), gap, silence);
+            sentenceOpen = true;
+
+            output->insert (output->end(), pcm, pcm + numBytes);
+            publishReady();
+            return ! cancelled && ! owner.isInterrupted (job);
+        }
+
+        void endSentence()
+        {
+            sentenceOpen = false;
+        }
+
+        bool isEmpty() const
+        {
+            return output->empty();
+        }
+
+        // Publishes the remainder plus the inter-phrase gap and returns the whole phrase,
+        // copied out of the growing stream buffer by makeCacheEntry().
+        RenderCache::Samples finish()
+        {
+            if (publishing)
+                publish (output->size(), true);
+
+            return owner.makeCacheEntry (*output);
+        }
+
+        // Terminates a phrase the audio thread may already be playing.
+        void abort()
+        {
+            if (numSegments > 0)
+                publish (published, true);
+        }
+
+    private:
+        static constexpr uint8_t silence = 128;
+
+        // A segment is only published once the context after it has been rendered.
+        void publishReady()
+        {
+            while (publishing
+                   && ! cancelled
+                   && numSegments < maxSegmentsPerPhrase - 1
+                   && output->size() - published >= nextSegmentSize + segmentContext)
+            {
+                publish (published + nextSegmentSize, false);
+                nextSegmentSize *= 2;
+            }
+        }
+
+        // The output keeps growing, so each segment gets its own copy of its span plus
+        // the context either side; the whole phrase is handed to the cache at the end.
+        void publish (size_t end, bool isLast)
+        {
+            const auto from = published - juce::jmin (published, segmentContext);
+            const auto to = juce::jmin (output->size(), end + segmentContext);
+
+            auto copy = owner.bufferPool.acquire (to - from);
+            copy->assign (output->begin() + static_cast<std::ptrdiff_t> (from), output->begin() + static_cast<std::ptrdiff_t> (to));
+
+            RenderedPhrase segment;
+            segment.buffer = std::move (copy);
+            segment.start = published - from;
+            segment.length = end - published;
+            segment.gapSamples = isLast ? getPhraseGapSamples() : 0;
+            segment.requestedAtMs = job.requestedAtMs;
+            segment.job = job.sequence;
+            segment.endsPhrase = isLast;
+
+            if (! owner.publishSegment (std::move (segment)))
+            {
+                cancelled = true;
+                return;
+            }
+
+            published = end;
+            ++numSegments;
+        }
+
+        SpeakNSpellVoice& owner;
+        const RenderJob& job;
+        const bool publishing;
+        PcmBufferPool::Buffer output;
+        size_t published = 0;
+        size_t nextSegmentSize;
+        int numSegments = 0;
+        bool sentenceOpen = false;
+        bool cancelled = false;
+    };
+
+    // The threads that render later sentences, shared by every voice in the process so
+    // that dozens of plugin instances don't each start a thread per core. Freed with the
+    // last voice.
+    struct SentencePool
+    {
+        juce::ThreadPool threads { juce::jmax (1, juce::SystemStats::getNumCpus() - 1) };
+    };
+
+    // One sentence of a long phrase, rendered on the sentence pool. Shared with the pool
+    // job so an abandoned render can finish safely after the worker, or the whole voice,
+    // has moved on.
+    struct SentenceRender
+    {
+        std::string text;
+        std::string key;
+        PcmBufferPool::Buffer pcm;
+        std::string error;
+        bool fromDisk = false;
+        std::atomic<bool> cancelled { false };
+        juce::WaitableEvent done { true };   // manual reset: waiting must not consume the signal
+    };
+
+    void renderJob (const RenderJob& job)
+    {
+        const auto text = mutateTextForRealtimeEffects (job.text, mutationAmount.load());
+        const auto phraseKey = makePhraseKey (text, job.params);
+
+        // Mutated text comes out different every time, so caching it would only push the
+        // phrases that do repeat out of memory and the pack.
+        const auto cacheable = text == job.text;
+
+        if (job.destination != RenderJob::Destination::playback)
+        {
+            if (! cacheable && job.destination == RenderJob::Destination::cache)
+                return;
+
+            auto rendered = warmCaches (text, job, phraseKey, cacheable);
+            if (rendered != nullptr && job.destination == RenderJob::Destination::notes)
+                publishNoteSource (std::move (rendered));
+            return;
+        }
+
+        if (auto cached = cacheable ? renderCache.find (phraseKey) : nullptr)
+        {
+            publishWholePhrase (std::move (cached), job);
+            return;
+        }
+
+        auto pcm = bufferPool.acquire (typicalPhraseBytes);
+        const auto fromDisk = cacheable && phrasePack.lookup (phraseKey, *pcm);
+
+        if (! fromDisk && job.params.backend == Parameters::Backend::classicSam)
+        {
+            renderSentences (text, job, phraseKey, cacheable);
+            return;
+        }
+
+        if (! fromDisk)
+        {
+            if (! renderSamPcmWithNode (text, job.params, *pcm))
+            {
+                if (status.load() == Status::rendering)
+                    reportFailure (Status::renderFailed);
+                return;
+            }
+
+            if (cacheable)
+                phrasePack.store (phraseKey, pcm->data(), pcm->size());
+        }
+
+        if (! cacheable)
+        {
+            publishWholePhrase (std::move (pcm), job);
+            return;
+        }
+
+        auto rendered = makeCacheEntry (*pcm);
+        renderCache.insert (phraseKey, rendered);
+        publishWholePhrase (std::move (rendered), job);
+    }
+
+    // Renders the way playback would, so a phrase key always names the same audio.
+    RenderCache::Samples warmCaches (const juce::String& text, const RenderJob& job, const std::string& phraseKey, bool cacheable)
+    {
+        if (auto cached = cacheable ? renderCache.find (phraseKey) : nullptr)
+            return cached;
+
+        auto pcm = bufferPool.acquire (typicalPhraseBytes);
+        if (! cacheable || ! phrasePack.lookup (phraseKey, *pcm))
+        {
+            if (job.params.backend == Parameters::Backend::classicSam)
+                return renderSentences (text, job, phraseKey, cacheable);
+
+            renderSamPcmWithNode (text, job.params, *pcm);
+
+            if (pcm->empty())
+                return {};
+
+            if (cacheable)
+                phrasePack.store (phraseKey, pcm->data(), pcm->size());
+        }
+
+        if (! cacheable)
+            return pcm;
+
+        auto rendered = makeCacheEntry (*pcm);
+        renderCache.insert (phraseKey, rendered);
+        return rendered;
+    }
+
+    // Render buffers are sized for a typical phrase or grown as a stream arrives, so the
+    // cache gets a copy in a buffer that fits. RenderCache budgets by capacity, which
+    // then stays close to what the phrase needs.
+    RenderCache::Samples makeCacheEntry (const std::vector<uint8_t>& pcm)
+    {
+        auto fitted = bufferPool.acquireFitted (pcm.size());
+        fitted->assign (pcm.begin(), pcm.end());
+        return fitted;
+    }
+
+    // The native engine streams: the first sentence is published while later frames are
+    // still rendering, and the remaining sentences render in parallel on the sentence
+    // pool, then join the stream in order. Returns the whole phrase, which is also what
+    // goes into the render cache.
+    RenderCache::Samples renderSentences (const juce::String& text, const RenderJob& job, const std::string& phraseKey, bool cacheable)
+    {
+        const auto settings = makeEngineSettings (job.params);
+        const auto sentenceTexts = splitIntoSentences (text);
+
+        std::vector<std::shared_ptr<SentenceRender>> sentences;
+        for (int i = 0; i < sentenceTexts.size(); ++i)
+        {
+            auto sentence = std::make_shared<SentenceRender>();
+            sentence->text = sentenceTexts[i].toStdString();
+            sentence->key = sentenceTexts.size() == 1 ? phraseKey : makePhraseKey (sentenceTexts[i], job.params);
+            sentence->pcm = bufferPool.acquire (typicalPhraseBytes);
+            // A single sentence is the whole phrase, which renderJob already looked up.
+            sentence->fromDisk = cacheable && sentenceTexts.size() > 1 && phrasePack.lookup (sentence->key, *sentence->pcm);
+
+            if (i > 0 && ! sentence->fromDisk)
+            {
+                sentencePool->threads.addJob ([sentence, settings]
+                {
+                    auto* s = sentence.get();
+                    s->error = SamEngine::renderInto (s->text, settings, [s] (const uint8_t*, size_t) { return ! s->cancelled.load(); }, *s->pcm);
+                    sentence->done.signal();
+                });
+            }
+            else
+            {
+                sentence->done.signal();
+            }
+
+            sentences.push_back (std::move (sentence));
+        }
+
+        PhraseStream stream (*this, job);
+        juce::String failure;
+        bool stopped = false;
+
+        for (size_t i = 0; i < sentences.size() && ! stopped; ++i)
+        {
+            auto& sentence = *sentences[i];
+
+            if (i == 0 && ! sentence.fromDisk)
+            {
+                sentence.error = SamEngine::renderInto (sentence.text, settings,
+                                                        [&stream] (const uint8_t* pcm, size_t numBytes) { return stream.push (pcm, numBytes); },
+                                                        *sentence.pcm);
+            }
+            else
+            {
+                while (! sentence.done.wait (50))
+                    if (renderWorker->threadShouldExit() || isInterrupted (job))
+                        break;
+
+                if (sentence.done.wait (0) && ! sentence.pcm->empty())
+                    stream.push (sentence.pcm->data(), sentence.pcm->size());
+            }
+
+            stream.endSentence();
+            stopped = renderWorker->threadShouldExit() || isInterrupted (job);
+            if (stopped)
+                break;
+
+            if (sentence.pcm->empty())
+            {
+                if (failure.isEmpty())
+                {
+                    failure = sentence.error.empty() ? "SAM produced no audio" : juce::String (sentence.error);
+                    if (sentences.size() > 1)
+                        failure = "sentence " + juce::String (static_cast<int> (i) + 1) + ": " + failure;
+                }
+            }
+            else if (cacheable && ! sentence.fromDisk)
+            {
+                phrasePack.store (sentence.key, sentence.pcm->data(), sentence.pcm->size());
+            }
+        }
+
+        if (stopped || stream.isEmpty())
+        {
+            for (auto& sentence : sentences)
+                sentence->cancelled.store (true);
+
+            stream.abort();
+            if (! stopped)
+                reportFailure (Status::samError, failure.isEmpty() ? "SAM produced no audio" : failure);
+            return {};
+        }
+
+        auto rendered = stream.finish();
+
+        // The sentences that did render still play, but a phrase with a hole in it is
+        // reported and kept out of the cache.
+        if (failure.isNotEmpty())
+        {
+            reportFailure (Status::samError, failure);
+            return rendered;
+        }
+
+        if (job.destination == RenderJob::Destination::playback)
+            reportQueued (rendered->size() + getPhraseGapSamples());
+        if (cacheable)
+            renderCache.insert (phraseKey, rendered);
+        return rendered;
+    }
+
+    // Splits after sentence and clause punctuation and at line breaks. Fragments with
+    // nothing to say are folded into their neighbour.
+    static juce::StringArray splitIntoSentences (const juce::String& text)
+    {
+        juce::StringArray sentences;
+        juce::String current;
+
+        const auto flush = [&]
+        {
+            const auto trimmed = current.trim();
+            current.clear();
+            if (trimmed.isEmpty())
+                return;
+
+            if (! trimmed.containsAnyOf ("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789") && sentences.size() > 0)
+                sentences.set (sentences.size() - 1, sentences[sentences.size() - 1] + trimmed);
+            else
+                sentences.add (trimmed);
+        };
+
+        for (int i = 0; i < text.length(); ++i)
+        {
+            const auto ch = text[i];
+            if (ch == '\n' || ch == '\r')
+            {
+                flush();
+                continue;
+            }
+
+            current << ch;
+
+            const auto next = text[i + 1];
+            if (juce::String (".!?;:").containsChar (ch) && (next == 0 || juce::CharacterFunctions::isWhitespace (next)))
+                flush();
+        }
+
+        flush();
+
+        if (sentences.isEmpty())
+            sentences.add (text);
+
+        return sentences;
+    }
+
+    // Shares the rendered buffer with the cache rather than copying it into the slot.
+    void publishWholePhrase (RenderCache::Samples rendered, const RenderJob& job)
+    {
+        RenderedPhrase phrase;
+        phrase.length = rendered->size();
+        phrase.buffer = std::move (rendered);
+        phrase.gapSamples = getPhraseGapSamples();
+        phrase.requestedAtMs = job.requestedAtMs;
+        phrase.job = job.sequence;
+        phrase.endsPhrase = true;
+
+        const auto numSamples = phrase.getNumSamples();
+        if (publishSegment (std::move (phrase)))
+            reportQueued (numSamples);
+    }
+
+    static size_t getPhraseGapSamples()
+    {
+        return static_cast<size_t> (0.04 * SamEngine::outputSampleRate);
+    }
+
+    // Worker thread only. Waits for the audio thread to hand back a slot; fails only
+    // when the worker is being stopped.
+    bool publishSegment (RenderedPhrase segment)
+    {
+        while (reclaimFreeSlots() == 0)
+        {
+            if (renderWorker->threadShouldExit())
+                return false;
+            renderWorker->wait (10);
+        }
+
+        const auto slot = spareSlots[static_cast<size_t> (--numSpareSlots)];
+        auto& phrase = phrases[static_cast<size_t> (slot)];
+        phrase = std::move (segment);
+        queuedSamples.fetch_add (static_cast<juce::int64> (phrase.getNumSamples()));
+        readyPhraseSlots.push (slot);
+        return true;
+    }
+
+    // Worker thread only. Takes back the slots the audio thread has finished with and
+    // drops their buffer references here, so the audio thread never frees samples and
+    // played audio doesn't linger until the slot is reused.
+    int reclaimFreeSlots()
+    {
+        int slot = -1;
+        while (freePhraseSlots.pop (slot))
+        {
+            phrases[static_cast<size_t> (slot)] = {};
+            spareSlots[static_cast<size_t> (numSpareSlots++)] = slot;
+        }
+
+        return numSpareSlots;
+    }
+
+    // Worker thread only. Note sources go through their own pair of slot queues: the
+    // audio thread hands a source back once no note is playing it any more.
+    void publishNoteSource (RenderCache::Samples samples)
+    {
+        if (samples->empty())
+            return;
+
+        while (reclaimNoteSources() == 0)
+        {
+            if (renderWorker->threadShouldExit())
+                return;
+            renderWorker->wait (10);
+        }
+
+        const auto source = spareNoteSources[static_cast<size_t> (--numSpareNoteSources)];
+        noteSources[static_cast<size_t> (source)] = std::move (samples);
+        readyNoteSources.push (source);
     }
 
-    void queueText (juce::String text, Parameters params)
+    int reclaimNoteSources()
     {
-        text = text.trim();
-        if (text.isEmpty())
+        int source = -1;
+        while (freeNoteSources.pop (source))
         {
-            setStatus ("Idle");
-            return;
+            noteSources[static_cast<size_t> (source)].reset();
+            spareNoteSources[static_cast<size_t> (numSpareNoteSources++)] = source;
         }
 
-        setStatus ("Rendering SAM...");
+        return numSpareNoteSources;
+    }
 
-        text = mutateTextForRealtimeEffects (text, getRealtimeControls().mutation);
-        auto samSamples = renderSamSamples (text, params);
-        if (samSamples.empty())
+    // Audio thread only. Takes the newest note source and hands back the ones that no
+    // note is playing any more.
+    void updateNoteSources()
+    {
+        int source = -1;
+        while (readyNoteSources.pop (source))
         {
-            if (getStatusText().startsWith ("Rendering"))
-                setStatus ("SAM render failed");
-            return;
+            if (currentNoteSource >= 0)
+                retiringNoteSources[static_cast<size_t> (numRetiringNoteSources++)] = currentNoteSource;
+            currentNoteSource = source;
         }
 
-        auto resampled = resample (samSamples, 22050.0, sampleRate);
-        if (resampled.empty())
+        for (int i = numRetiringNoteSources; --i >= 0;)
         {
-            setStatus ("Resample failed");
-            return;
-        }
-
-        const juce::SpinLock::ScopedLockType sl (audioLock);
-        audioQueue.insert (audioQueue.end(), resampled.begin(), resampled.end());
+            const auto retiring = retiringNoteSources[static_cast<size_t> (i)];
+            if (notePool.isSourceInUse (retiring))
+                continue;
 
-        const auto gapSamples = static_cast<int> (0.04 * sampleRate);
-        audioQueue.insert (audioQueue.end(), static_cast<size_t> (juce::jmax (0, gapSamples)), 0.0f);
-        loopSource = resampled;
-        loopSource.insert (loopSource.end(), static_cast<size_t> (juce::jmax (0, gapSamples)), 0.0f);
-        setStatus ("Queued " + juce::String (static_cast<int> (resampled.size())) + " samples");
+            freeNoteSources.push (retiring);
+            retiringNoteSources[static_cast<size_t> (i)] = retiringNoteSources[static_cast<size_t> (--numRetiringNoteSources)];
+        }
     }
 
-    juce::String getStatusText() const
+    // Identifies the native-rate SAM output. The memory cache and the phrase pack both use
+    // it as is: phrases are stored unresampled, so the host rate plays no part.
+    static std::string makePhraseKey (const juce::String& text, const Parameters& params)
     {
-        const juce::SpinLock::ScopedLockType sl (statusLock);
-        return statusText;
+        juce::String key;
+        key << params.speed << ' ' << params.pitch << ' ' << params.mouth << ' ' << params.throat << ' '
+            << (params.singMode ? 1 : 0) << ' ' << (params.phoneticInput ? 1 : 0) << ' '
+            << static_cast<int> (params.backend) << '\n' << text;
+        return key.toStdString();
     }
 
-    void render (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    // Audio thread only. Slots are handed back to the worker rather than freed here.
+    // All segments of the current phrase are held until the next phrase starts, so
+    // looping can replay them.
+    void advancePhrase (double nowMs)
     {
-        auto* left = buffer.getWritePointer (0, startSample);
-        auto* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer (1, startSample) : nullptr;
-
-        const juce::SpinLock::ScopedLockType sl (audioLock);
-        const auto controls = getRealtimeControls();
-        const auto speed = juce::jlimit (0.25f, 4.0f, controls.playbackSpeed);
-        const auto pitchRatio = std::pow (2.0, static_cast<double> (controls.repitchSemitones) / 12.0);
+        int next = -1;
 
-        for (int i = 0; i < numSamples; ++i)
+        if (currentPhrase >= 0 && ! phrases[static_cast<size_t> (currentPhrase)].endsPhrase)
         {
-            float out = 0.0f;
-            const auto jitter = nextJitterRatio (controls.repitchJitter);
-            const auto step = juce::jlimit (0.05, 8.0, static_cast<double> (speed) * pitchRatio * jitter);
-            const auto sample = getSampleAtPlayhead();
-            if (sample.has_value())
+            if (currentSegment + 1 < numHeldSegments)
             {
-                out = *sample;
-                playhead += step;
+                currentPhrase = heldSegments[static_cast<size_t> (++currentSegment)];
+                playhead = 0.0;
             }
+            else if (popReadySegment (next))
+            {
+                // Nothing will replay a finished segment unless we loop, so hand it back now.
+                if (! loopAtEnd.load())
+                    releaseHeldSegments();
 
-            out = processRealtimeEffects (out, controls);
+                heldSegments[static_cast<size_t> (numHeldSegments++)] = next;
+                currentSegment = numHeldSegments - 1;
+                currentPhrase = next;
+                playhead = 0.0;
+            }
 
-            left[i] = out;
-            if (right != nullptr)
-                right[i] = out;
+            // Otherwise the rest is still rendering: play silence until it lands.
+            return;
         }
 
-        if (playhead >= audioQueue.size())
+        if (popReadySegment (next))
         {
-            if (loopAtEnd.load() && ! loopSource.empty())
-            {
-                audioQueue = loopSource;
-                playhead = 0.0;
-                setStatus ("Looping");
-            }
-            else
-            {
-                const bool hadAudio = ! audioQueue.empty();
-                audioQueue.clear();
-                playhead = 0.0;
-                if (hadAudio)
-                    setStatus ("Idle");
-            }
+            releaseHeldSegments();
+            heldSegments[0] = next;
+            numHeldSegments = 1;
+            currentSegment = 0;
+            currentPhrase = next;
+            playhead = 0.0;
+            lastTriggerLatencyMs.store (nowMs - phrases[static_cast<size_t> (next)].requestedAtMs);
+            return;
         }
-    }
 
-    void setLoopAtEnd (bool shouldLoop)
-    {
-        loopAtEnd.store (shouldLoop);
-    }
+        if (currentPhrase < 0)
+            return;
 
-    bool getLoopAtEnd() const
-    {
-        return loopAtEnd.load();
-    }
+        playhead = 0.0;
+        if (loopAtEnd.load())
+        {
+            currentSegment = 0;
+            currentPhrase = heldSegments[0];
+            loopsPlayed.fetch_add (1);
+            status.store (Status::looping);
+            return;
+        }
 
-    void setRealtimeControls (const RealtimeControls& controls)
-    {
-        playbackSpeed.store (juce::jlimit (0.25f, 4.0f, controls.playbackSpeed));
-        repitchSemitones.store (juce::jlimit (-24.0f, 24.0f, controls.repitchSemitones));
-        formantWarp.store (juce::jlimit (0.0f, 1.0f, controls.formantWarp));
-        glitchGate.store (juce::jlimit (0.0f, 1.0f, controls.glitchGate));
-        bitCrush.store (juce::jlimit (0.0f, 1.0f, controls.bitCrush));
-        microLoop.store (juce::jlimit (0.0f, 1.0f, controls.microLoop));
-        spectralTilt.store (juce::jlimit (0.0f, 1.0f, controls.spectralTilt));
-        ringMod.store (juce::jlimit (0.0f, 1.0f, controls.ringMod));
-        freqShift.store (juce::jlimit (0.0f, 1.0f, controls.freqShift));
-        repitchJitter.store (juce::jlimit (0.0f, 1.0f, controls.repitchJitter));
-        mutation.store (juce::jlimit (0.0f, 1.0f, controls.mutation));
+        releaseHeldSegments();
+        currentPhrase = -1;
+        status.store (Status::idle);
     }
 
-    RealtimeControls getRealtimeControls() const
+    // Segments rendered for an interrupted job go straight back to the worker.
+    bool popReadySegment (int& slot)
     {
-        RealtimeControls c;
-        c.playbackSpeed = playbackSpeed.load();
-        c.repitchSemitones = repitchSemitones.load();
-        c.formantWarp = formantWarp.load();
-        c.glitchGate = glitchGate.load();
-        c.bitCrush = bitCrush.load();
-        c.microLoop = microLoop.load();
-        c.spectralTilt = spectralTilt.load();
-        c.ringMod = ringMod.load();
-        c.freqShift = freqShift.load();
-        c.repitchJitter = repitchJitter.load();
-        c.mutation = mutation.load();
-        return c;
-    }
+        while (readyPhraseSlots.pop (slot))
+        {
+            const auto& phrase = phrases[static_cast<size_t> (slot)];
+            queuedSamples.fetch_sub (static_cast<juce::int64> (phrase.getNumSamples()));
 
-    void setCustomNodePath (juce::String path)
-    {
-        path = path.trim();
-        const juce::SpinLock::ScopedLockType sl (nodePathLock);
-        customNodePath = path;
+            if (! isInterrupted (phrase.job))
+                return true;
+
+            freePhraseSlots.push (slot);
+        }
+
+        return false;
     }
 
-    juce::String getCustomNodePath() const
+    void releaseHeldSegments()
     {
-        const juce::SpinLock::ScopedLockType sl (nodePathLock);
-        return customNodePath;
+        for (int i = 0; i < numHeldSegments; ++i)
+            freePhraseSlots.push (heldSegments[static_cast<size_t> (i)]);
+
+        numHeldSegments = 0;
+        currentSegment = 0;
     }
 
-private:
     juce::String mutateTextForRealtimeEffects (const juce::String& text, float amount) const
     {
         amount = juce::jlimit (0.0f, 1.0f, amount);
@@ -313,10 +1460,6 @@ private:
 
     double nextJitterRatio (float jitterAmount)
     {
-        jitterAmount = juce::jlimit (0.0f, 1.0f, jitterAmount);
-        if (jitterAmount <= 0.001f)
-            return 1.0;
-
         if (--jitterCounter <= 0)
         {
             const auto span = 0.35 * static_cast<double> (jitterAmount);
@@ -327,169 +1470,481 @@ private:
         return jitterRatio;
     }
 
-    float processRealtimeEffects (float in, const RealtimeControls& controls)
+    static constexpr float RealtimeControls::* smoothedFields[] {
+        &RealtimeControls::playbackSpeed, &RealtimeControls::repitchSemitones, &RealtimeControls::formantWarp,
+        &RealtimeControls::glitchGate, &RealtimeControls::bitCrush, &RealtimeControls::microLoop,
+        &RealtimeControls::spectralTilt, &RealtimeControls::ringMod, &RealtimeControls::freqShift,
+        &RealtimeControls::repitchJitter
+    };
+
+    bool controlsSettledAt (const RealtimeControls& target) const
     {
-        auto out = in;
-        out = applyMicroLoop (out, controls.microLoop);
-        out = applyFormantWarp (out, controls.formantWarp);
-        out = applySpectralTilt (out, controls.spectralTilt);
-        out = applyGlitchGate (out, controls.glitchGate);
-        out = applyBitCrush (out, controls.bitCrush);
-        out = applyRingMod (out, controls.ringMod);
-        out = applyFrequencyShift (out, controls.freqShift);
-        return juce::jlimit (-1.0f, 1.0f, out);
+        if (! controlsSmoothingPrimed)
+            return false;
+
+        for (auto field : smoothedFields)
+            if (smoothedControls.*field != target.*field)
+                return false;
+
+        return true;
     }
 
-    float applyFormantWarp (float x, float amount)
+    // Glides the controls towards `target` with a one-pole step over numSamples, so knob
+    // moves and automation don't land as steps. Mutation only affects rendering.
+    const RealtimeControls& smoothControls (const RealtimeControls& target, int numSamples)
     {
-        amount = juce::jlimit (0.0f, 1.0f, amount);
-        if (amount <= 0.001f)
-            return x;
+        if (! controlsSmoothingPrimed)
+        {
+            smoothedControls = target;
+            controlsSmoothingPrimed = true;
+            return smoothedControls;
+        }
 
-        const auto warp = 0.75 + 1.5 * static_cast<double> (amount);
-        const auto f1 = juce::jlimit (0.002, 0.25, (900.0 * warp) / sampleRate);
-        const auto f2 = juce::jlimit (0.002, 0.25, (2200.0 * warp) / sampleRate);
+        const auto coeff = static_cast<float> (1.0 - std::exp (-static_cast<double> (numSamples) / (controlSmoothingSeconds * sampleRate)));
+        for (auto field : smoothedFields)
+        {
+            auto& value = smoothedControls.*field;
+            const auto goal = target.*field;
+            value += (goal - value) * coeff;
+            if (std::abs (goal - value) < 1.0e-4f)
+                value = goal;
+        }
 
-        formant1 += static_cast<float> (f1) * (x - formant1);
-        const auto hp1 = x - formant1;
-        formantBand1 += static_cast<float> (f1) * (hp1 - formantBand1);
+        smoothedControls.mutation = target.mutation;
+        return smoothedControls;
+    }
 
-        formant2 += static_cast<float> (f2) * (x - formant2);
-        const auto hp2 = x - formant2;
-        formantBand2 += static_cast<float> (f2) * (hp2 - formantBand2);
+    // In output samples per output sample; getSourceStep() converts to native samples.
+    static double getPlaybackStep (const RealtimeControls& controls)
+    {
+        const auto speed = juce::jlimit (0.25f, 4.0f, controls.playbackSpeed);
+        const auto pitchRatio = std::pow (2.0, static_cast<double> (controls.repitchSemitones) / 12.0);
+        return static_cast<double> (speed) * pitchRatio;
+    }
 
-        return x + amount * 0.75f * (formantBand1 * 0.7f + formantBand2 * 0.45f);
+    double getSourceStep() const
+    {
+        return SamEngine::outputSampleRate / sampleRate;
     }
 
-    float applySpectralTilt (float x, float amount)
+    const Pcm8Interpolator& getInterpolator() const
     {
-        amount = juce::jlimit (0.0f, 1.0f, amount);
-        if (amount <= 0.001f)
-            return x;
+        return interpolators[static_cast<size_t> (resampleQuality.load())];
+    }
 
-        const auto tilt = (amount * 2.0f) - 1.0f;
-        tiltLp += 0.03f * (x - tiltLp);
-        const auto hp = x - tiltLp;
-        return x + tilt * (tiltLp * 0.8f - hp * 0.55f);
+    // Built off the audio thread for every quality tier, so switching tiers mid-phrase
+    // never allocates.
+    void prepareInterpolators()
+    {
+        for (size_t i = 0; i < interpolators.size(); ++i)
+            interpolators[i].prepare (SamEngine::outputSampleRate, sampleRate, static_cast<PolyphaseResampler::Quality> (i));
     }
 
-    float applyGlitchGate (float x, float amount)
+    // Reads the phrase queue into `out` at the current speed and pitch, resampling from
+    // the native PCM as it goes. Once nothing is left to play the rest of the block is
+    // silent; a phrase that lands meanwhile starts on the next block.
+    void renderPlayback (float* out, int numSamples, const RealtimeControls& controls)
     {
-        amount = juce::jlimit (0.0f, 1.0f, amount);
-        if (amount <= 0.001f)
-            return x;
+        const auto baseStep = getPlaybackStep (controls);
+        const auto sourceStep = getSourceStep();
+        const auto jitterAmount = juce::jlimit (0.0f, 1.0f, controls.repitchJitter);
+        const auto jitterActive = jitterAmount > 0.001f;
+        const auto fixedStep = juce::jlimit (0.05, 8.0, baseStep) * sourceStep;
+        const auto& interpolator = getInterpolator();
+        const auto blockStartMs = juce::Time::getMillisecondCounterHiRes();
+
+        if (currentPhrase >= 0 && isInterrupted (phrases[static_cast<size_t> (currentPhrase)].job))
+        {
+            releaseHeldSegments();
+            currentPhrase = -1;
+            playhead = 0.0;
+        }
+
+        for (int i = 0; i < numSamples;)
+        {
+            if (! hasSampleAtPlayhead())
+            {
+                advancePhrase (blockStartMs + 1000.0 * static_cast<double> (i) / sampleRate);
+                if (! hasSampleAtPlayhead())
+                {
+                    juce::FloatVectorOperations::clear (out + i, numSamples - i);
+                    return;
+                }
+            }
+
+            const auto& phrase = phrases[static_cast<size_t> (currentPhrase)];
+            const auto* pcm = phrase.buffer->data();
+            const auto numBytes = phrase.buffer->size();
+            const auto start = static_cast<double> (phrase.start);
+            const auto size = static_cast<double> (phrase.getNumSamples());
+
+            if (! jitterActive)
+            {
+                const auto count = juce::jmin (numSamples - i, juce::jmax (1, static_cast<int> (std::ceil ((size - playhead) / fixedStep))));
+                playhead = interpolator.process (pcm, numBytes, start + playhead, fixedStep, out + i, count) - start;
+                i += count;
+                continue;
+            }
+
+            for (; i < numSamples && playhead < size; ++i)
+            {
+                out[i] = interpolator.read (pcm, numBytes, start + playhead);
+                playhead += juce::jlimit (0.05, 8.0, baseStep * nextJitterRatio (jitterAmount)) * sourceStep;
+            }
+        }
+    }
+
+    // Bits for the stages that can be bypassed; the micro-loop always runs because it
+    // keeps its history current while bypassed.
+    enum EffectStage : unsigned
+    {
+        formantWarpStage  = 1u << 0,
+        spectralTiltStage = 1u << 1,
+        glitchGateStage   = 1u << 2,
+        bitCrushStage     = 1u << 3,
+        ringModStage      = 1u << 4,
+        freqShiftStage    = 1u << 5,
+        numEffectChains   = 1u << 6
+    };
+
+    using EffectChain = void (SpeakNSpellVoice::*) (float*, int, const RealtimeControls&);
+
+    static bool isStageActive (float amount)
+    {
+        return juce::jlimit (0.0f, 1.0f, amount) > 0.001f;
+    }
+
+    static unsigned getActiveStages (const RealtimeControls& controls)
+    {
+        return (isStageActive (controls.formantWarp)  ? formantWarpStage  : 0u)
+             | (isStageActive (controls.spectralTilt) ? spectralTiltStage : 0u)
+             | (isStageActive (controls.glitchGate)   ? glitchGateStage   : 0u)
+             | (isStageActive (controls.bitCrush)     ? bitCrushStage     : 0u)
+             | (isStageActive (controls.ringMod)      ? ringModStage      : 0u)
+             | (isStageActive (controls.freqShift)    ? freqShiftStage    : 0u);
+    }
+
+    template <unsigned... Masks>
+    static constexpr std::array<EffectChain, sizeof... (Masks)> makeEffectChains (std::integer_sequence<unsigned, Masks...>)
+    {
+        return { &SpeakNSpellVoice::runEffectChain<Masks>... };
+    }
+
+    // Picks the chain compiled for exactly the stages that are on, once per block.
+    void processRealtimeEffects (float* x, int numSamples, const RealtimeControls& controls)
+    {
+        static constexpr auto chains = makeEffectChains (std::make_integer_sequence<unsigned, numEffectChains> {});
+        (this->*chains[getActiveStages (controls)]) (x, numSamples, controls);
+    }
+
+    template <unsigned Active>
+    void runEffectChain (float* x, int numSamples, const RealtimeControls& controls)
+    {
+        applyMicroLoop (x, numSamples, controls.microLoop);
+
+        constexpr auto filters = Active & (formantWarpStage | spectralTiltStage);
+        if constexpr (filters == (formantWarpStage | spectralTiltStage))
+            runFilters (x, numSamples, FormantWarpFilter (*this, controls.formantWarp), SpectralTiltFilter (*this, controls.spectralTilt));
+        else if constexpr (filters == formantWarpStage)
+            runFilters (x, numSamples, FormantWarpFilter (*this, controls.formantWarp));
+        else if constexpr (filters == spectralTiltStage)
+            runFilters (x, numSamples, SpectralTiltFilter (*this, controls.spectralTilt));
+
+        if constexpr ((Active & glitchGateStage) != 0)
+            applyGlitchGate (x, numSamples, controls.glitchGate);
+
+        if constexpr ((Active & bitCrushStage) != 0)
+            applyBitCrush (x, numSamples, controls.bitCrush);
+
+        if constexpr ((Active & ringModStage) != 0)
+            applyRingMod (x, numSamples, controls.ringMod);
 
-        if (--gateCounter <= 0)
+        if constexpr ((Active & freqShiftStage) != 0)
+            applyFrequencyShift (x, numSamples, controls.freqShift);
+
+        juce::FloatVectorOperations::clip (x, x, -1.0f, 1.0f, numSamples);
+    }
+
+    // Runs consecutive per-sample filters in one pass with their state in locals.
+    template <typename... Filters>
+    static void runFilters (float* x, int numSamples, Filters... filters)
+    {
+        for (int i = 0; i < numSamples; ++i)
         {
-            gateCounter = juce::jmax (1, static_cast<int> (sampleRate * (0.005 + (0.08 * (1.0 - amount)))));
-            gateOpen = rng.nextFloat() > (0.25f + 0.6f * amount);
+            auto v = x[i];
+            ((v = filters.process (v)), ...);
+            x[i] = v;
         }
-        return gateOpen ? x : 0.0f;
+
+        (filters.store(), ...);
     }
 
-    float applyBitCrush (float x, float amount)
+    struct FormantWarpFilter
+    {
+        FormantWarpFilter (SpeakNSpellVoice& v, float amount)
+            : voice (v),
+              lp1 (v.formant1), lp2 (v.formant2), band1 (v.formantBand1), band2 (v.formantBand2)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            const auto warp = 0.75 + 1.5 * static_cast<double> (amount);
+            f1 = static_cast<float> (juce::jlimit (0.002, 0.25, (900.0 * warp) / v.sampleRate));
+            f2 = static_cast<float> (juce::jlimit (0.002, 0.25, (2200.0 * warp) / v.sampleRate));
+            depth = amount * 0.75f;
+        }
+
+        float process (float in)
+        {
+            lp1 += f1 * (in - lp1);
+            band1 += f1 * ((in - lp1) - band1);
+            lp2 += f2 * (in - lp2);
+            band2 += f2 * ((in - lp2) - band2);
+            return in + depth * (band1 * 0.7f + band2 * 0.45f);
+        }
+
+        void store()
+        {
+            voice.formant1 = lp1;
+            voice.formant2 = lp2;
+            voice.formantBand1 = band1;
+            voice.formantBand2 = band2;
+        }
+
+        SpeakNSpellVoice& voice;
+        float lp1, lp2, band1, band2;
+        float f1 = 0.0f, f2 = 0.0f, depth = 0.0f;
+    };
+
+    struct SpectralTiltFilter
+    {
+        SpectralTiltFilter (SpeakNSpellVoice& v, float amount)
+            : voice (v), lp (v.tiltLp), tilt (juce::jlimit (0.0f, 1.0f, amount) * 2.0f - 1.0f)
+        {
+        }
+
+        float process (float in)
+        {
+            lp += 0.03f * (in - lp);
+            return in + tilt * (lp * 0.8f - (in - lp) * 0.55f);
+        }
+
+        void store()
+        {
+            voice.tiltLp = lp;
+        }
+
+        SpeakNSpellVoice& voice;
+        float lp, tilt;
+    };
+
+    // The gate only changes state when its counter runs out, so work in runs.
+    void applyGlitchGate (float* x, int numSamples, float amount)
     {
         amount = juce::jlimit (0.0f, 1.0f, amount);
         if (amount <= 0.001f)
-            return x;
+            return;
+
+        const auto period = juce::jmax (1, static_cast<int> (sampleRate * (0.005 + (0.08 * (1.0 - amount)))));
+        const auto closeChance = 0.25f + 0.6f * amount;
 
-        if (--crushHoldCounter <= 0)
+        for (int i = 0; i < numSamples;)
         {
-            crushHoldCounter = 1 + static_cast<int> (amount * amount * 42.0f);
-            crushHeldSample = x;
+            if (--gateCounter <= 0)
+            {
+                gateCounter = period;
+                gateOpen = rng.nextFloat() > closeChance;
+            }
+
+            const auto run = juce::jmin (numSamples - i, gateCounter);
+            if (! gateOpen)
+                juce::FloatVectorOperations::clear (x + i, run);
+
+            gateCounter -= run - 1;
+            i += run;
         }
+    }
+
+    // Sample-and-hold then quantise: constant across each hold, so fill in runs.
+    void applyBitCrush (float* x, int numSamples, float amount)
+    {
+        amount = juce::jlimit (0.0f, 1.0f, amount);
+        if (amount <= 0.001f)
+            return;
 
+        const auto hold = 1 + static_cast<int> (amount * amount * 42.0f);
         const auto bits = juce::jlimit (3, 16, 16 - static_cast<int> (amount * 13.0f));
         const auto levels = static_cast<float> (1 << bits);
-        return std::floor ((crushHeldSample * 0.5f + 0.5f) * levels) / levels * 2.0f - 1.0f;
+
+        // No hold: every sample is its own run, so quantise the block in lanes.
+        if (hold == 1 && numSamples > 0)
+        {
+            crushHoldCounter = 1;
+            crushHeldSample = x[numSamples - 1];
+            EffectKernels::quantise (x, numSamples, levels);
+            return;
+        }
+
+        for (int i = 0; i < numSamples;)
+        {
+            if (--crushHoldCounter <= 0)
+            {
+                crushHoldCounter = hold;
+                crushHeldSample = x[i];
+            }
+
+            const auto run = juce::jmin (numSamples - i, crushHoldCounter);
+            const auto crushed = std::floor ((crushHeldSample * 0.5f + 0.5f) * levels) / levels * 2.0f - 1.0f;
+            juce::FloatVectorOperations::fill (x + i, crushed, run);
+
+            crushHoldCounter -= run - 1;
+            i += run;
+        }
     }
 
-    float applyRingMod (float x, float amount)
+    void applyRingMod (float* x, int numSamples, float amount)
     {
         amount = juce::jlimit (0.0f, 1.0f, amount);
         if (amount <= 0.001f)
-            return x;
+            return;
 
         const auto freq = 18.0 + 740.0 * static_cast<double> (amount);
-        ringPhase += juce::MathConstants<double>::twoPi * (freq / sampleRate);
-        if (ringPhase > juce::MathConstants<double>::twoPi)
-            ringPhase -= juce::MathConstants<double>::twoPi;
-        const auto mod = static_cast<float> (std::sin (ringPhase));
-        return x * ((1.0f - amount) + amount * mod);
+        ringOscillator.setIncrement (juce::MathConstants<double>::twoPi * (freq / sampleRate));
+
+        for (int start = 0; start < numSamples; start += QuadratureOscillator::chunkSize)
+        {
+            float carrier[QuadratureOscillator::chunkSize];
+            const auto count = juce::jmin (QuadratureOscillator::chunkSize, numSamples - start);
+            ringOscillator.process (carrier, nullptr, count);
+            EffectKernels::ringMod (x + start, carrier, count, 1.0f - amount, amount);
+        }
     }
 
-    float applyFrequencyShift (float x, float amount)
+    void applyFrequencyShift (float* x, int numSamples, float amount)
     {
         amount = juce::jlimit (0.0f, 1.0f, amount);
         if (amount <= 0.001f)
-            return x;
+            return;
 
         const auto freq = 35.0 + 1200.0 * static_cast<double> (amount);
-        shiftPhase += juce::MathConstants<double>::twoPi * (freq / sampleRate);
-        if (shiftPhase > juce::MathConstants<double>::twoPi)
-            shiftPhase -= juce::MathConstants<double>::twoPi;
+        const auto increment = juce::MathConstants<double>::twoPi * (freq / sampleRate);
+
+        // The shifter's allpass state is left over from whenever it last ran, so switching
+        // to it starts it clean instead of with a click.
+        const auto mode = getFrequencyShiftMode();
+        if (mode != shiftModeInUse)
+        {
+            shiftModeInUse = mode;
+            if (mode == FrequencyShiftMode::singleSideband)
+                frequencyShifter.reset();
+        }
+
+        // Each ring-mod sideband sat at 0.9 * amount, so the single sideband does too.
+        if (mode == FrequencyShiftMode::singleSideband)
+        {
+            frequencyShifter.process (x, numSamples, increment, 1.0f - amount * 0.65f, amount * 0.9f);
+            return;
+        }
+
+        shiftOscillator.setIncrement (increment);
 
-        const auto carrier = static_cast<float> (std::cos (shiftPhase));
-        const auto shifted = x * carrier * 1.8f;
-        return juce::jlimit (-1.0f, 1.0f, x * (1.0f - amount * 0.65f) + shifted * amount);
+        for (int start = 0; start < numSamples; start += QuadratureOscillator::chunkSize)
+        {
+            float carrier[QuadratureOscillator::chunkSize];
+            const auto count = juce::jmin (QuadratureOscillator::chunkSize, numSamples - start);
+            shiftOscillator.process (nullptr, carrier, count);
+            EffectKernels::frequencyShift (x + start, carrier, count, 1.0f - amount * 0.65f, amount * 1.8f);
+        }
     }
 
-    float applyMicroLoop (float x, float amount)
+    void applyMicroLoop (float* x, int numSamples, float amount)
     {
         amount = juce::jlimit (0.0f, 1.0f, amount);
-        history[static_cast<size_t> (historyWrite)] = x;
-        historyWrite = (historyWrite + 1) % static_cast<int> (history.size());
-
         if (amount <= 0.001f)
         {
+            // Keep the history current so switching the effect on loops recent audio.
             loopActive = false;
-            return x;
+            writeHistory (x, numSamples);
+            return;
         }
 
-        if (loopActive)
-        {
-            const auto idx = (loopStart + loopPos) % static_cast<int> (history.size());
-            const auto y = history[static_cast<size_t> (idx)];
-            loopPos = (loopPos + 1) % juce::jmax (1, loopLength);
-            if (--loopRemain <= 0)
-                loopActive = false;
-            return y;
-        }
+        const auto historySize = static_cast<int> (history.size());
+        const auto triggerPeriod = juce::jmax (1, static_cast<int> (sampleRate * (0.03 + (0.22 * (1.0 - amount)))));
+        const auto triggerChance = 0.18f + 0.72f * amount;
 
-        if (--loopTriggerCounter <= 0)
+        for (int i = 0; i < numSamples; ++i)
         {
-            loopTriggerCounter = juce::jmax (1, static_cast<int> (sampleRate * (0.03 + (0.22 * (1.0 - amount)))));
-            if (rng.nextFloat() < (0.18f + 0.72f * amount))
+            const auto in = x[i];
+            history[static_cast<size_t> (historyWrite)] = in;
+            historyWrite = (historyWrite + 1) % historySize;
+
+            if (loopActive)
+            {
+                const auto idx = (loopStart + loopPos) % historySize;
+                x[i] = history[static_cast<size_t> (idx)];
+                loopPos = (loopPos + 1) % juce::jmax (1, loopLength);
+                if (--loopRemain <= 0)
+                    loopActive = false;
+                continue;
+            }
+
+            if (--loopTriggerCounter <= 0)
             {
-                loopLength = juce::jlimit (24, static_cast<int> (history.size()) / 2, 24 + static_cast<int> (amount * 1500.0f));
-                loopRemain = juce::jmax (loopLength, static_cast<int> (loopLength * (1.0f + amount * 4.0f)));
-                loopStart = (historyWrite + static_cast<int> (history.size()) - loopLength) % static_cast<int> (history.size());
-                loopPos = 0;
-                loopActive = true;
+                loopTriggerCounter = triggerPeriod;
+                if (rng.nextFloat() < triggerChance)
+                {
+                    loopLength = juce::jlimit (24, historySize / 2, 24 + static_cast<int> (amount * 1500.0f));
+                    loopRemain = juce::jmax (loopLength, static_cast<int> (loopLength * (1.0f + amount * 4.0f)));
+                    loopStart = (historyWrite + historySize - loopLength) % historySize;
+                    loopPos = 0;
+                    loopActive = true;
+                }
             }
         }
+    }
+
+    void writeHistory (const float* x, int numSamples)
+    {
+        const auto historySize = static_cast<int> (history.size());
+        if (numSamples >= historySize)
+        {
+            std::copy (x + numSamples - historySize, x + numSamples, history.begin());
+            historyWrite = 0;
+            return;
+        }
 
-        return x;
+        const auto firstPart = juce::jmin (numSamples, historySize - historyWrite);
+        std::copy (x, x + firstPart, history.begin() + historyWrite);
+        std::copy (x + firstPart, x + numSamples, history.begin());
+        historyWrite = (historyWrite + numSamples) % historySize;
     }
 
-    std::optional<float> getSampleAtPlayhead() const
+    bool hasSampleAtPlayhead() const
     {
-        if (playhead >= static_cast<double> (audioQueue.size()))
-            return std::nullopt;
+        return currentPhrase >= 0 && playhead < static_cast<double> (phrases[static_cast<size_t> (currentPhrase)].getNumSamples());
+    }
+
+    // Worker thread only: the detail string is the one part of the status that allocates.
+    void reportFailure (Status failure, const juce::String& detail = {})
+    {
+        {
+            const juce::SpinLock::ScopedLockType sl (failureLock);
+            failureDetail = detail;
+        }
 
-        const auto i0 = static_cast<size_t> (playhead);
-        const auto i1 = juce::jmin (i0 + 1, audioQueue.size() - 1);
-        const auto frac = static_cast<float> (playhead - static_cast<double> (i0));
+        renderFailures.fetch_add (1);
+        status.store (failure);
+    }
 
-        const auto a = audioQueue[i0];
-        const auto b = audioQueue[i1];
-        return a + (b - a) * frac;
+    void reportQueued (size_t numSamples)
+    {
+        lastQueuedSamples.store (static_cast<juce::int64> (numSamples));
+        rendersQueued.fetch_add (1);
+        status.store (Status::queued);
     }
 
-    void setStatus (const juce::String& text) const
+    juce::String getFailureDetail() const
     {
-        const juce::SpinLock::ScopedLockType sl (statusLock);
-        statusText = text;
+        const juce::SpinLock::ScopedLockType sl (failureLock);
+        return failureDetail;
     }
 
     static juce::File findProjectFile (const juce::String& relativePath)
@@ -610,55 +2065,28 @@ private:
         return "node";
     }
 
-    static std::vector<float> decodePcm8 (const juce::MemoryBlock& block)
+    static SamEngine::Settings makeEngineSettings (const Parameters& params)
     {
-        const auto bytes = block.getSize();
-        if (bytes == 0)
-            return {};
-
-        const auto* src = static_cast<const uint8_t*> (block.getData());
-        const auto count = static_cast<size_t> (bytes);
-        std::vector<float> out (count);
-        for (size_t i = 0; i < count; ++i)
-            out[i] = (static_cast<float> (src[i]) - 128.0f) / 256.0f;
-        return out;
+        SamEngine::Settings settings;
+        settings.speed = params.speed;
+        settings.pitch = params.pitch;
+        settings.mouth = params.mouth;
+        settings.throat = params.throat;
+        settings.singMode = params.singMode;
+        settings.phoneticInput = params.phoneticInput;
+        return settings;
     }
 
-    static std::vector<float> resample (const std::vector<float>& in, double sourceRate, double targetRate)
+    // Fills pcm, which is left empty on failure.
+    bool renderSamPcmWithNode (const juce::String& text, const Parameters& params, std::vector<uint8_t>& pcm)
     {
-        if (in.empty() || sourceRate <= 0.0 || targetRate <= 0.0)
-            return {};
-
-        if (std::abs (sourceRate - targetRate) < 1.0)
-            return in;
-
-        const auto ratio = sourceRate / targetRate;
-        const auto outCount = static_cast<size_t> (std::max (1.0, std::floor (static_cast<double> (in.size()) * (targetRate / sourceRate))));
-        std::vector<float> out;
-        out.resize (outCount);
+        pcm.clear();
 
-        double pos = 0.0;
-        for (size_t i = 0; i < outCount; ++i)
-        {
-            const auto idx = static_cast<size_t> (std::floor (pos));
-            const auto frac = static_cast<float> (pos - static_cast<double> (idx));
-
-            const auto a = in[juce::jmin (idx, in.size() - 1)];
-            const auto b = in[juce::jmin (idx + 1, in.size() - 1)];
-            out[i] = a + (b - a) * frac;
-            pos += ratio;
-        }
-
-        return out;
-    }
-
-    std::vector<float> renderSamSamples (const juce::String& text, const Parameters& params) const
-    {
         auto scriptPath = findProjectFile ("Source/sam_bridge.js");
         if (! scriptPath.existsAsFile())
         {
-            setStatus ("Missing Source/sam_bridge.js");
-            return {};
+            reportFailure (Status::missingFile, "Source/sam_bridge.js");
+            return false;
         }
 
         const auto backendLib = (params.backend == Parameters::Backend::betterSam)
@@ -667,89 +2095,98 @@ private:
         auto samLibPath = findProjectFile (backendLib);
         if (! samLibPath.existsAsFile())
         {
-            setStatus ("Missing " + juce::String (backendLib));
-            return {};
-        }
-
-        juce::ChildProcess proc;
-        juce::StringArray args;
-        const auto nodePath = findNodeBinary();
-        auto tempFile = juce::File::getSpecialLocation (juce::File::tempDirectory)
-                            .getNonexistentChildFile ("sam-render-", ".pcm", false);
-
-        args.add (nodePath);
-        args.add (scriptPath.getFullPathName());
-        args.add (tempFile.getFullPathName());
-        args.add (juce::String (juce::jlimit (1, 255, params.speed)));
-        args.add (juce::String (juce::jlimit (0, 255, params.pitch)));
-        args.add (juce::String (juce::jlimit (0, 255, params.mouth)));
-        args.add (juce::String (juce::jlimit (0, 255, params.throat)));
-        args.add (params.singMode ? "1" : "0");
-        args.add (params.phoneticInput ? "1" : "0");
-        args.add (params.backend == Parameters::Backend::betterSam ? "better" : "classic");
-        args.add (text);
-
-        if (! proc.start (args))
-        {
-            setStatus ("Failed to launch Node: " + nodePath + " (set SAM_NODE_PATH or install Node.js)");
-            return {};
+            reportFailure (Status::missingFile, backendLib);
+            return false;
         }
 
-        const auto deadline = juce::Time::getMillisecondCounter() + 12000u;
-        while (proc.isRunning() && juce::Time::getMillisecondCounter() < deadline)
+        SamNodeWorker::Request request;
+        request.text = text;
+        request.speed = params.speed;
+        request.pitch = params.pitch;
+        request.mouth = params.mouth;
+        request.throat = params.throat;
+        request.singMode = params.singMode;
+        request.phoneticInput = params.phoneticInput;
+        request.betterBackend = params.backend == Parameters::Backend::betterSam;
+
+        const auto error = nodeWorker.render (findNodeBinary(), scriptPath, request, 12000, pcm);
+        if (error.isNotEmpty())
         {
-            (void) proc.readAllProcessOutput();
-            juce::Thread::sleep (10);
+            pcm.clear();
+            reportFailure (Status::nodeError, error);
+            return false;
         }
 
-        if (proc.isRunning())
-        {
-            proc.kill();
-            setStatus ("SAM render timeout");
-            return {};
-        }
+        return ! pcm.empty();
+    }
 
-        (void) proc.readAllProcessOutput();
+    static constexpr int numPhraseSlots = 16;
+    static constexpr int numNoteSources = 4;
 
-        juce::MemoryBlock pcmData;
-        if (! tempFile.existsAsFile() || ! tempFile.loadFileAsData (pcmData))
-        {
-            auto errFile = tempFile.getSiblingFile (tempFile.getFileName() + ".err.txt");
-            if (errFile.existsAsFile())
-            {
-                setStatus ("SAM error: " + errFile.loadFileAsString().upToFirstOccurrenceOf ("\n", false, false));
-                errFile.deleteFile();
-            }
-            else
-            {
-                setStatus ("SAM output file missing");
-            }
-            return {};
-        }
-        tempFile.deleteFile();
+    // A streamed phrase may use at most half the slots, so the audio thread holding a
+    // looping phrase can never starve the worker of slots for the next one.
+    static constexpr int maxSegmentsPerPhrase = numPhraseSlots / 2;
+    static constexpr double streamFirstSegmentSeconds = 0.1;
+    static constexpr auto typicalPhraseBytes = static_cast<size_t> (2.0 * SamEngine::outputSampleRate);
 
-        return decodePcm8 (pcmData);
-    }
+    // Native samples copied either side of a streamed segment, enough for the widest
+    // interpolation kernel.
+    static constexpr size_t segmentContext = 128;
+    static constexpr double controlSmoothingSeconds = 0.02;
+    static constexpr int controlSmoothingStep = 32;
 
     double sampleRate = 44100.0;
+    std::atomic<int> resampleQuality { static_cast<int> (PolyphaseResampler::Quality::standard) };
+    std::array<Pcm8Interpolator, 3> interpolators;
+    std::atomic<int> frequencyShiftMode { static_cast<int> (FrequencyShiftMode::singleSideband) };
+
+    // Guarded by jobLock.
+    juce::SpinLock jobLock;
+    PendingJobs<maxPendingPlaybackJobs> playbackJobs;
+    PendingJobs<maxPendingBackgroundJobs> backgroundJobs;
+    juce::uint32 nextPlaybackJob = 0;
+
+    std::atomic<juce::uint32> cutPlaybackBefore { 0 };
+    std::atomic<double> maxQueuedSeconds { QueueLimits().maxQueuedSeconds };
+    std::atomic<int> maxPendingJobs { QueueLimits().maxPendingJobs };
+    std::atomic<int> queuePolicy { static_cast<int> (QueueLimits().policy) };
+    std::atomic<juce::uint32> droppedMessages { 0 };
+    std::atomic<juce::uint32> coalescedMessages { 0 };
+    std::atomic<juce::uint32> queueInterrupts { 0 };
+
+    std::array<RenderedPhrase, numPhraseSlots> phrases;
+    PhraseSlotFifo<numPhraseSlots> readyPhraseSlots;
+    PhraseSlotFifo<numPhraseSlots> freePhraseSlots;
+    int currentPhrase = -1;
+    std::array<int, numPhraseSlots> spareSlots {};
+    int numSpareSlots = 0;
+    std::atomic<juce::int64> queuedSamples { 0 };
+    std::atomic<juce::int64> currentSamplesLeft { 0 };
+    std::array<int, maxSegmentsPerPhrase> heldSegments {};
+    int numHeldSegments = 0;
+    int currentSegment = 0;
+    std::atomic<double> lastTriggerLatencyMs { -1.0 };
+
+    std::array<RenderCache::Samples, numNoteSources> noteSources;
+    PhraseSlotFifo<numNoteSources> readyNoteSources;
+    PhraseSlotFifo<numNoteSources> freeNoteSources;
+    std::array<int, numNoteSources> spareNoteSources {};
+    int numSpareNoteSources = 0;
+    int currentNoteSource = -1;
+    std::array<int, numNoteSources> retiringNoteSources {};
+    int numRetiringNoteSources = 0;
+    NoteVoicePool notePool;
+    std::atomic<int> numActiveNotes { 0 };
 
-    juce::SpinLock audioLock;
-    std::vector<float> audioQueue;
-    std::vector<float> loopSource;
     double playhead = 0.0;
     std::atomic<bool> loopAtEnd { false };
 
-    std::atomic<float> playbackSpeed { 1.0f };
-    std::atomic<float> repitchSemitones { 0.0f };
-    std::atomic<float> formantWarp { 0.0f };
-    std::atomic<float> glitchGate { 0.0f };
-    std::atomic<float> bitCrush { 0.0f };
-    std::atomic<float> microLoop { 0.0f };
-    std::atomic<float> spectralTilt { 0.0f };
-    std::atomic<float> ringMod { 0.0f };
-    std::atomic<float> freqShift { 0.0f };
-    std::atomic<float> repitchJitter { 0.0f };
-    std::atomic<float> mutation { 0.0f };
+    mutable juce::SpinLock controlsLock;
+    RealtimeControls latestControls;
+    TripleBuffer<RealtimeControls> controlsSnapshot;
+    RealtimeControls smoothedControls;
+    bool controlsSmoothingPrimed = false;
+    std::atomic<float> mutationAmount { 0.0f };
 
     juce::Random rng;
     int jitterCounter = 0;
@@ -761,8 +2198,10 @@ private:
     int crushHoldCounter = 1;
     float crushHeldSample = 0.0f;
 
-    double ringPhase = 0.0;
-    double shiftPhase = 0.0;
+    QuadratureOscillator ringOscillator;
+    QuadratureOscillator shiftOscillator;
+    FrequencyShifter frequencyShifter;
+    FrequencyShiftMode shiftModeInUse = FrequencyShiftMode::singleSideband;
 
     float formant1 = 0.0f;
     float formant2 = 0.0f;
@@ -779,9 +2218,25 @@ private:
     int loopRemain = 0;
     int loopTriggerCounter = 1;
 
+    SamNodeWorker nodeWorker;
+    PcmBufferPool bufferPool;
+    RenderCache renderCache;
+    PhrasePackCache phrasePack;
+
     mutable juce::SpinLock nodePathLock;
     juce::String customNodePath;
 
-    mutable juce::SpinLock statusLock;
-    mutable juce::String statusText { "Idle" };
+    std::atomic<Status> status { Status::idle };
+    std::atomic<juce::int64> lastQueuedSamples { 0 };
+    std::atomic<juce::uint32> rendersQueued { 0 };
+    std::atomic<juce::uint32> renderFailures { 0 };
+    std::atomic<juce::uint32> loopsPlayed { 0 };
+
+    mutable juce::SpinLock failureLock;
+    juce::String failureDetail;
+
+    juce::SharedResourcePointer<SentencePool> sentencePool;
+    std::unique_ptr<RenderWorker> renderWorker;
+
+    JUCE_DECLARE_NON_COPYABLE (SpeakNSpellVoice)
 };
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands the newest copy of a value from one writer to one reader without either side
+// waiting. The writer fills its own slot and swaps it into the middle; the reader
+// swaps the middle out only when it holds something newer than what it has, so a
+// read always sees one complete write. Several writers must take turns under their
+// own lock; the reader side never locks.
+template <typename Value>
+class TripleBuffer
+{
+public:
+    explicit TripleBuffer (const Value& initial = {})
+    {
+        slots.fill (initial);
+    }
+
+    void write (const Value& value)
+    {
+        slots[static_cast<size_t> (back)] = value;
+        back = middle.exchange (back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    const Value& read()
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshBit) != 0)
+            front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+
+        return slots[static_cast<size_t> (front)];
+    }
+
+private:
+    static constexpr int freshBit = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<Value, 3> slots;
+    int back = 0;
+    std::atomic<int> middle { 1 };
+    int front = 2;
+};
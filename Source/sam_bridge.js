@@ -1,54 +1,165 @@
 const path = require('path');
 const fs = require('fs');
 
-const outPath = process.argv[2];
-const speed = Math.max(1, Math.min(255, Number(process.argv[3] || 72) | 0));
-const pitch = Math.max(0, Math.min(255, Number(process.argv[4] || 64) | 0));
-const mouth = Math.max(0, Math.min(255, Number(process.argv[5] || 128) | 0));
-const throat = Math.max(0, Math.min(255, Number(process.argv[6] || 128) | 0));
-const singmode = (process.argv[7] || "0") === "1";
-const phonetic = (process.argv[8] || "0") === "1";
-const backend = (process.argv[9] || "classic").trim().toLowerCase();
-const text = process.argv.slice(10).join(' ').trim();
-
-if (!outPath || !text) {
-  process.exit(0);
+const libs = {};
+
+function loadSam(backend) {
+  const lib = backend === "better" ? "better-samjs.common.js" : "samjs.common.js";
+  if (!libs[lib]) {
+    libs[lib] = require(path.resolve(__dirname, '..', 'third_party', lib));
+  }
+  return libs[lib];
 }
 
-const oldLog = console.log;
-const oldWarn = console.warn;
-const oldError = console.error;
-console.log = () => {};
-console.warn = () => {};
-console.error = () => {};
+function clampInt(value, fallback, lo, hi) {
+  return Math.max(lo, Math.min(hi, Number(value || fallback) | 0));
+}
 
-try {
-  const lib = backend === "better" ? "better-samjs.common.js" : "samjs.common.js";
-  const samPath = path.resolve(__dirname, '..', 'third_party', lib);
-  const Sam = require(samPath);
-  const sam = new Sam({ speed, pitch, mouth, throat, singmode, phonetic: false });
+function renderPcm(opts) {
+  const Sam = loadSam(opts.backend);
+  const sam = new Sam({
+    speed: opts.speed,
+    pitch: opts.pitch,
+    mouth: opts.mouth,
+    throat: opts.throat,
+    singmode: opts.singmode,
+    phonetic: false
+  });
   let out = null;
-  if (phonetic) {
+  if (opts.phonetic) {
     try {
-      out = sam.buf8(text, true);
+      out = sam.buf8(opts.text, true);
     } catch (_) {
       out = null;
     }
   }
   if (!out || !out.length) {
-    out = sam.buf8(text, false);
+    out = sam.buf8(opts.text, false);
   }
   if (!out || !out.length) {
     throw new Error("SAM produced no audio");
   }
-  fs.writeFileSync(outPath, Buffer.from(out));
-} catch (err) {
+  return out;
+}
+
+function muteConsole() {
+  const saved = { log: console.log, warn: console.warn, error: console.error };
+  console.log = () => {};
+  console.warn = () => {};
+  console.error = () => {};
+  return () => {
+    console.log = saved.log;
+    console.warn = saved.warn;
+    console.error = saved.error;
+  };
+}
+
+// --server: stay resident and answer framed requests on a loopback socket.
+// The chosen port is announced on stdout as "SAM_SERVER_PORT <port>".
+//   request:  u32le size | u8 speed | u8 pitch | u8 mouth | u8 throat | u8 flags | utf-8 text
+//             flags: 1 = sing mode, 2 = phonetic input, 4 = better backend
+//   response: u8 status (0 = pcm, 1 = error) | u32le size | payload
+function runServer() {
+  const net = require('net');
+  muteConsole();
+  loadSam("classic");
+  loadSam("better");
+
+  const respond = (socket, status, payload) => {
+    const header = Buffer.alloc(5);
+    header.writeUInt8(status, 0);
+    header.writeUInt32LE(payload.length, 1);
+    socket.write(Buffer.concat([header, payload]));
+  };
+
+  const handleFrame = (socket, frame) => {
+    if (frame.length < 5) {
+      respond(socket, 1, Buffer.from("Malformed request"));
+      return;
+    }
+    const flags = frame[4];
+    const text = frame.subarray(5).toString('utf8').trim();
+    if (!text) {
+      respond(socket, 1, Buffer.from("No text to render"));
+      return;
+    }
+    try {
+      const out = renderPcm({
+        speed: Math.max(1, frame[0]),
+        pitch: frame[1],
+        mouth: frame[2],
+        throat: frame[3],
+        singmode: (flags & 1) !== 0,
+        phonetic: (flags & 2) !== 0,
+        backend: (flags & 4) !== 0 ? "better" : "classic",
+        text
+      });
+      respond(socket, 0, Buffer.from(out));
+    } catch (err) {
+      respond(socket, 1, Buffer.from(String(err && err.stack ? err.stack : err)));
+    }
+  };
+
+  const server = net.createServer((socket) => {
+    clearTimeout(connectTimer);
+    let pending = Buffer.alloc(0);
+    socket.setNoDelay(true);
+    socket.on('data', (chunk) => {
+      pending = Buffer.concat([pending, chunk]);
+      while (pending.length >= 4) {
+        const size = pending.readUInt32LE(0);
+        if (pending.length < 4 + size) {
+          break;
+        }
+        const frame = pending.subarray(4, 4 + size);
+        pending = pending.subarray(4 + size);
+        handleFrame(socket, frame);
+      }
+    });
+    socket.on('error', () => {});
+    // One host per worker: when it goes away, so do we.
+    socket.on('close', () => process.exit(0));
+  });
+
+  const connectTimer = setTimeout(() => process.exit(0), 10000);
+  server.listen(0, '127.0.0.1', () => {
+    process.stdout.write("SAM_SERVER_PORT " + server.address().port + "\n");
+  });
+}
+
+function runOnce() {
+  const outPath = process.argv[2];
+  const text = process.argv.slice(10).join(' ').trim();
+
+  if (!outPath || !text) {
+    process.exit(0);
+  }
+
+  const restoreConsole = muteConsole();
   try {
-    fs.writeFileSync(outPath + ".err.txt", String(err && err.stack ? err.stack : err));
-  } catch (_) {}
-  process.exitCode = 1;
-} finally {
-  console.log = oldLog;
-  console.warn = oldWarn;
-  console.error = oldError;
+    const out = renderPcm({
+      speed: clampInt(process.argv[3], 72, 1, 255),
+      pitch: clampInt(process.argv[4], 64, 0, 255),
+      mouth: clampInt(process.argv[5], 128, 0, 255),
+      throat: clampInt(process.argv[6], 128, 0, 255),
+      singmode: (process.argv[7] || "0") === "1",
+      phonetic: (process.argv[8] || "0") === "1",
+      backend: (process.argv[9] || "classic").trim().toLowerCase(),
+      text
+    });
+    fs.writeFileSync(outPath, Buffer.from(out));
+  } catch (err) {
+    try {
+      fs.writeFileSync(outPath + ".err.txt", String(err && err.stack ? err.stack : err));
+    } catch (_) {}
+    process.exitCode = 1;
+  } finally {
+    restoreConsole();
+  }
+}
+
+if (process.argv[2] === "--server") {
+  runServer();
+} else {
+  runOnce();
 }
@@ -0,0 +1,381 @@
+#include "SpeakNSpellVoice.h"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Times the realtime effect chain for each factory preset, in ns per 512-sample block,
+// against the chains it replaced, which are kept here as references: the per-sample
+// chain, and the generic block chain that ran the filter stages as separate passes. The
+// voice can only be timed whole, so it is timed idle and its chain is the preset's
+// render minus a dry render at the same speed and pitch. No stage branches on the
+// signal, so silence costs what speech does, and the references run over silence too.
+// Only the check that the fused filter pass matches the separate ones can fail; the
+// timings are for reading.
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int warmUpBlocks = 200;
+    constexpr int timedBlocks = 4000;
+
+    // Every stage runs on every sample, re-clamping its amount and checking its bypass.
+    struct PerSampleChain
+    {
+        float process (float x, const SpeakNSpellVoice::RealtimeControls& controls)
+        {
+            x = applyMicroLoop (x, controls.microLoop);
+            x = applyFormantWarp (x, controls.formantWarp);
+            x = applySpectralTilt (x, controls.spectralTilt);
+            x = applyGlitchGate (x, controls.glitchGate);
+            x = applyBitCrush (x, controls.bitCrush);
+            x = applyRingMod (x, controls.ringMod);
+            x = applyFrequencyShift (x, controls.freqShift);
+            return juce::jlimit (-1.0f, 1.0f, x);
+        }
+
+        float applyFormantWarp (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return x;
+
+            const auto warp = 0.75 + 1.5 * static_cast<double> (amount);
+            const auto f1 = juce::jlimit (0.002, 0.25, (900.0 * warp) / sampleRate);
+            const auto f2 = juce::jlimit (0.002, 0.25, (2200.0 * warp) / sampleRate);
+
+            formant1 += static_cast<float> (f1) * (x - formant1);
+            formantBand1 += static_cast<float> (f1) * ((x - formant1) - formantBand1);
+            formant2 += static_cast<float> (f2) * (x - formant2);
+            formantBand2 += static_cast<float> (f2) * ((x - formant2) - formantBand2);
+            return x + amount * 0.75f * (formantBand1 * 0.7f + formantBand2 * 0.45f);
+        }
+
+        float applySpectralTilt (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return x;
+
+            tiltLp += 0.03f * (x - tiltLp);
+            return x + (amount * 2.0f - 1.0f) * (tiltLp * 0.8f - (x - tiltLp) * 0.55f);
+        }
+
+        float applyGlitchGate (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return x;
+
+            if (--gateCounter <= 0)
+            {
+                gateCounter = juce::jmax (1, static_cast<int> (sampleRate * (0.005 + (0.08 * (1.0 - amount)))));
+                gateOpen = rng.nextFloat() > (0.25f + 0.6f * amount);
+            }
+            return gateOpen ? x : 0.0f;
+        }
+
+        float applyBitCrush (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return x;
+
+            if (--crushHoldCounter <= 0)
+            {
+                crushHoldCounter = 1 + static_cast<int> (amount * amount * 42.0f);
+                crushHeldSample = x;
+            }
+
+            const auto levels = static_cast<float> (1 << juce::jlimit (3, 16, 16 - static_cast<int> (amount * 13.0f)));
+            return std::floor ((crushHeldSample * 0.5f + 0.5f) * levels) / levels * 2.0f - 1.0f;
+        }
+
+        float applyRingMod (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return x;
+
+            ringPhase += juce::MathConstants<double>::twoPi * ((18.0 + 740.0 * static_cast<double> (amount)) / sampleRate);
+            if (ringPhase > juce::MathConstants<double>::twoPi)
+                ringPhase -= juce::MathConstants<double>::twoPi;
+            return x * ((1.0f - amount) + amount * static_cast<float> (std::sin (ringPhase)));
+        }
+
+        float applyFrequencyShift (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return x;
+
+            shiftPhase += juce::MathConstants<double>::twoPi * ((35.0 + 1200.0 * static_cast<double> (amount)) / sampleRate);
+            if (shiftPhase > juce::MathConstants<double>::twoPi)
+                shiftPhase -= juce::MathConstants<double>::twoPi;
+
+            const auto shifted = x * static_cast<float> (std::cos (shiftPhase)) * 1.8f;
+            return juce::jlimit (-1.0f, 1.0f, x * (1.0f - amount * 0.65f) + shifted * amount);
+        }
+
+        float applyMicroLoop (float x, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            const auto historySize = static_cast<int> (history.size());
+            history[static_cast<size_t> (historyWrite)] = x;
+            historyWrite = (historyWrite + 1) % historySize;
+
+            if (amount <= 0.001f)
+            {
+                loopActive = false;
+                return x;
+            }
+
+            if (loopActive)
+            {
+                const auto y = history[static_cast<size_t> ((loopStart + loopPos) % historySize)];
+                loopPos = (loopPos + 1) % juce::jmax (1, loopLength);
+                if (--loopRemain <= 0)
+                    loopActive = false;
+                return y;
+            }
+
+            if (--loopTriggerCounter <= 0)
+            {
+                loopTriggerCounter = juce::jmax (1, static_cast<int> (sampleRate * (0.03 + (0.22 * (1.0 - amount)))));
+                if (rng.nextFloat() < (0.18f + 0.72f * amount))
+                {
+                    loopLength = juce::jlimit (24, historySize / 2, 24 + static_cast<int> (amount * 1500.0f));
+                    loopRemain = juce::jmax (loopLength, static_cast<int> (loopLength * (1.0f + amount * 4.0f)));
+                    loopStart = (historyWrite + historySize - loopLength) % historySize;
+                    loopPos = 0;
+                    loopActive = true;
+                }
+            }
+
+            return x;
+        }
+
+        juce::Random rng;
+        int gateCounter = 1;
+        bool gateOpen = true;
+        int crushHoldCounter = 1;
+        float crushHeldSample = 0.0f;
+        double ringPhase = 0.0, shiftPhase = 0.0;
+        float formant1 = 0.0f, formant2 = 0.0f, formantBand1 = 0.0f, formantBand2 = 0.0f, tiltLp = 0.0f;
+        std::array<float, 4096> history {};
+        int historyWrite = 0;
+        bool loopActive = false;
+        int loopStart = 0, loopPos = 0, loopLength = 64, loopRemain = 0, loopTriggerCounter = 1;
+    };
+
+    // The generic chain shared every stage with the specialised one except the filters,
+    // which ran as one pass each. Their state lives in members that the compiler has to
+    // reload and store on every sample, because x might alias them.
+    struct SeparateFilterPasses
+    {
+        void process (float* x, int numSamples, const SpeakNSpellVoice::RealtimeControls& controls)
+        {
+            applyFormantWarp (x, numSamples, controls.formantWarp);
+            applySpectralTilt (x, numSamples, controls.spectralTilt);
+        }
+
+        void applyFormantWarp (float* x, int numSamples, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return;
+
+            const auto warp = 0.75 + 1.5 * static_cast<double> (amount);
+            const auto f1 = static_cast<float> (juce::jlimit (0.002, 0.25, (900.0 * warp) / sampleRate));
+            const auto f2 = static_cast<float> (juce::jlimit (0.002, 0.25, (2200.0 * warp) / sampleRate));
+            const auto depth = amount * 0.75f;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto in = x[i];
+                formant1 += f1 * (in - formant1);
+                formantBand1 += f1 * ((in - formant1) - formantBand1);
+                formant2 += f2 * (in - formant2);
+                formantBand2 += f2 * ((in - formant2) - formantBand2);
+                x[i] = in + depth * (formantBand1 * 0.7f + formantBand2 * 0.45f);
+            }
+        }
+
+        void applySpectralTilt (float* x, int numSamples, float amount)
+        {
+            amount = juce::jlimit (0.0f, 1.0f, amount);
+            if (amount <= 0.001f)
+                return;
+
+            const auto tilt = amount * 2.0f - 1.0f;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto in = x[i];
+                tiltLp += 0.03f * (in - tiltLp);
+                x[i] = in + tilt * (tiltLp * 0.8f - (in - tiltLp) * 0.55f);
+            }
+        }
+
+        float formant1 = 0.0f, formant2 = 0.0f, formantBand1 = 0.0f, formantBand2 = 0.0f, tiltLp = 0.0f;
+    };
+
+    // The fastest of several rounds, so one preemption doesn't land in the table.
+    template <typename Fn>
+    double nanosecondsPerBlock (int numBlocks, Fn&& fn)
+    {
+        constexpr int rounds = 5;
+        double fastest = 0.0;
+        for (int round = 0; round < rounds; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (int b = 0; b < numBlocks / rounds; ++b)
+                fn (round * numBlocks / rounds + b);
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            fastest = round == 0 ? elapsed.count() : juce::jmin (fastest, elapsed.count());
+        }
+        return fastest / (numBlocks / rounds);
+    }
+
+    // Keeps the reference output alive so the compiler can't drop the work.
+    volatile float sink = 0.0f;
+
+    bool queuePhrase (SpeakNSpellVoice& voice)
+    {
+        voice.setSampleRate (sampleRate);
+        voice.queueText ("The quick brown fox jumps over the lazy dog.", {});
+
+        const auto deadline = juce::Time::getMillisecondCounter() + 20000;
+        while (voice.getStatusCounters().renders == 0 && juce::Time::getMillisecondCounter() < deadline)
+            juce::Thread::sleep (1);
+
+        return voice.getStatusCounters().renders > 0;
+    }
+
+    // Plays a phrase through two voices, one dry and one with both filter stages on, and
+    // counts the samples where the separate passes over the dry voice's output disagree
+    // with the filtered voice. A streamed phrase is segmented differently from one read
+    // back whole, so a first voice fills the pack and both compared voices read from it.
+    int checkFilters (const juce::File& pack)
+    {
+        SpeakNSpellVoice::RealtimeControls filtered;
+        filtered.formantWarp = 0.6f;
+        filtered.spectralTilt = 0.3f;
+
+        SpeakNSpellVoice primer (pack), dryVoice (pack), filteredVoice (pack);
+        for (auto* voice : { &primer, &dryVoice, &filteredVoice })
+        {
+            if (! queuePhrase (*voice))
+            {
+                std::printf ("FAIL the phrase did not render\n");
+                return 1;
+            }
+        }
+
+        juce::AudioBuffer<float> dry (1, blockSize), wet (1, blockSize);
+        SeparateFilterPasses filters;
+        int mismatches = 0;
+        float peak = 0.0f;
+
+        for (int b = 0; b < 200; ++b)
+        {
+            dryVoice.render (dry, 0, blockSize, {});
+            filteredVoice.render (wet, 0, blockSize, filtered);
+
+            auto* x = dry.getWritePointer (0);
+            filters.process (x, blockSize, filtered);
+            juce::FloatVectorOperations::clip (x, x, -1.0f, 1.0f, blockSize);
+
+            for (int i = 0; i < blockSize; ++i)
+                mismatches += x[i] != wet.getSample (0, i) ? 1 : 0;
+            peak = juce::jmax (peak, wet.getMagnitude (0, 0, blockSize));
+        }
+
+        std::printf ("filter stages: %d of %d samples differ from the separate passes (peak %.3f)\n",
+                     mismatches, 200 * blockSize, (double) peak);
+        return mismatches == 0 && peak > 0.0f ? 0 : 1;
+    }
+
+    // The preset's playback settings with every effect off.
+    SpeakNSpellVoice::RealtimeControls withoutEffects (const SpeakNSpellVoice::RealtimeControls& controls)
+    {
+        SpeakNSpellVoice::RealtimeControls dry;
+        dry.playbackSpeed = controls.playbackSpeed;
+        dry.repitchSemitones = controls.repitchSemitones;
+        dry.repitchJitter = controls.repitchJitter;
+        return dry;
+    }
+}
+
+int main()
+{
+    const auto pack = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                          .getNonexistentChildFile ("sam-effect-chain-test-", ".pack", false);
+    const auto failures = checkFilters (pack);
+    pack.deleteFile();
+
+    SpeakNSpellVoice voice (pack);
+    voice.setSampleRate (sampleRate);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    const std::vector<float> silence (static_cast<size_t> (blockSize));
+    std::vector<float> scratch (static_cast<size_t> (blockSize));
+
+    auto renderBlocks = [&] (int numBlocks, const SpeakNSpellVoice::RealtimeControls& controls)
+    {
+        return nanosecondsPerBlock (numBlocks, [&] (int) { voice.render (buffer, 0, blockSize, controls); });
+    };
+
+    std::printf ("%-15s %10s %10s   %s\n", "preset", "render", "dry", "effects per sample -> generic -> specialised");
+
+    for (int preset = 0; preset < SpeakNSpellVoice::getNumFactoryPresets(); ++preset)
+    {
+        SpeakNSpellVoice::Parameters params;
+        SpeakNSpellVoice::RealtimeControls controls;
+        SpeakNSpellVoice::applyFactoryPreset (preset, params, controls);
+        const auto dry = withoutEffects (controls);
+
+        // Warm-ups let the control smoothing settle on each set before it is timed.
+        renderBlocks (warmUpBlocks, dry);
+        const auto dryNs = renderBlocks (timedBlocks, dry);
+        renderBlocks (warmUpBlocks, controls);
+        const auto renderNs = renderBlocks (timedBlocks, controls);
+
+        // Heap objects, so the compiler can't assume the signal never aliases their state,
+        // just as it couldn't when they were members of the voice.
+        auto perSample = std::make_unique<PerSampleChain>();
+        const auto perSampleNs = nanosecondsPerBlock (timedBlocks, [&] (int)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                scratch[static_cast<size_t> (i)] = perSample->process (silence[static_cast<size_t> (i)], controls);
+            sink = scratch.back();
+        });
+
+        // The generic chain is the voice with its filters off plus the separate passes.
+        auto genericNs = renderNs - dryNs;
+        if (controls.formantWarp > 0.0f || controls.spectralTilt > 0.0f)
+        {
+            auto withoutFilters = controls;
+            withoutFilters.formantWarp = 0.0f;
+            withoutFilters.spectralTilt = 0.0f;
+            renderBlocks (warmUpBlocks, withoutFilters);
+            const auto withoutFiltersNs = renderBlocks (timedBlocks, withoutFilters);
+
+            auto filters = std::make_unique<SeparateFilterPasses>();
+            const auto filtersNs = nanosecondsPerBlock (timedBlocks, [&] (int)
+            {
+                std::copy (silence.begin(), silence.end(), scratch.begin());
+                filters->process (scratch.data(), blockSize, controls);
+                sink = scratch.back();
+            });
+
+            genericNs = withoutFiltersNs - dryNs + filtersNs;
+        }
+
+        std::printf ("%-15s %7.0f ns %7.0f ns %10.0f -> %6.0f -> %6.0f ns\n", SpeakNSpellVoice::getFactoryPresetName (preset).toRawUTF8(),
+                     renderNs, dryNs, perSampleNs, genericNs, renderNs - dryNs);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include "EffectKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Runs each four-lane kernel against the per-sample formula it replaced, over block
+// lengths that leave every possible scalar tail, and fails if any sample drifts.
+namespace
+{
+    constexpr float tolerance = 2.0e-6f;
+
+    std::vector<float> noise (int numSamples, float range, unsigned seed)
+    {
+        std::mt19937 rng (seed);
+        std::uniform_real_distribution<float> dist (-range, range);
+        std::vector<float> v ((size_t) numSamples);
+        for (auto& s : v)
+            s = dist (rng);
+        return v;
+    }
+
+    float worstDifference (const std::vector<float>& a, const std::vector<float>& b)
+    {
+        float worst = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i)
+            worst = std::max (worst, std::abs (a[i] - b[i]));
+        return worst;
+    }
+
+    int check (const char* name, int numSamples, float worst, float limit)
+    {
+        if (worst <= limit)
+            return 0;
+
+        std::printf ("FAIL %s, %d samples: max difference %g\n", name, numSamples, (double) worst);
+        return 1;
+    }
+}
+
+int main()
+{
+    int failures = 0, cases = 0;
+
+    for (int numSamples : { 0, 1, 2, 3, 4, 5, 7, 8, 63, 64, 65, 441, 512, 4099 })
+    {
+        // Inputs run slightly past full scale so the clamp in frequencyShift is exercised.
+        const auto input = noise (numSamples, 1.2f, 1);
+        const auto carrier = noise (numSamples, 1.0f, 2);
+
+        for (float dry : { 0.0f, 0.4f, 1.0f })
+        {
+            auto simd = input, scalar = input;
+            EffectKernels::ringMod (simd.data(), carrier.data(), numSamples, dry, 1.0f - dry);
+            for (int i = 0; i < numSamples; ++i)
+                scalar[(size_t) i] *= dry + (1.0f - dry) * carrier[(size_t) i];
+            failures += check ("ringMod", numSamples, worstDifference (simd, scalar), tolerance);
+
+            simd = input;
+            scalar = input;
+            EffectKernels::frequencyShift (simd.data(), carrier.data(), numSamples, dry, 0.9f);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto& x = scalar[(size_t) i];
+                x = std::clamp (x * dry + x * carrier[(size_t) i] * 0.9f, -1.0f, 1.0f);
+            }
+            failures += check ("frequencyShift", numSamples, worstDifference (simd, scalar), tolerance);
+            cases += 2;
+        }
+
+        // Quantising lands on discrete steps, so anything but an exact match means a
+        // sample was rounded onto a different step.
+        for (float levels : { 2.0f, 8.0f, 255.0f, 65536.0f })
+        {
+            auto simd = input, scalar = input;
+            EffectKernels::quantise (simd.data(), numSamples, levels);
+            for (auto& x : scalar)
+                x = std::floor ((x * 0.5f + 0.5f) * levels) / levels * 2.0f - 1.0f;
+            failures += check ("quantise", numSamples, worstDifference (simd, scalar), 0.0f);
+            ++cases;
+        }
+    }
+
+    std::printf ("%d kernel cases, %d failed\n", cases, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include "SpeakNSpellVoice.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Plays a note at a range of positions inside host blocks of several sizes, splitting
+// each block at the event the way processBlock does, and fails unless the note comes
+// out exactly that many samples after where it starts in a reference render.
+namespace
+{
+    constexpr int captureLength = 12000;
+
+    // Renders silence in host-sized blocks until no note is sounding any more. The note
+    // count is only updated by render(), so at least one block always runs.
+    void drain (SpeakNSpellVoice& voice, juce::AudioBuffer<float>& buffer)
+    {
+        voice.allNotesOff();
+        for (int i = 0; i < 1000; ++i)
+        {
+            voice.render (buffer, 0, buffer.getNumSamples());
+            if (voice.getNumActiveNotes() == 0)
+                break;
+        }
+    }
+
+    // Streams blocks of blockSize and plays middle C at absolute sample `onset`.
+    std::vector<float> playNoteAt (SpeakNSpellVoice& voice, int blockSize, int onset)
+    {
+        juce::AudioBuffer<float> buffer (1, blockSize);
+        std::vector<float> captured;
+
+        for (int blockStart = 0; (int) captured.size() < onset + captureLength; blockStart += blockSize)
+        {
+            buffer.clear();
+            const auto position = onset - blockStart;
+
+            if (position >= 0 && position < blockSize)
+            {
+                voice.render (buffer, 0, position);
+                voice.noteOn (60, 1.0f);
+                voice.render (buffer, position, blockSize - position);
+            }
+            else
+            {
+                voice.render (buffer, 0, blockSize);
+            }
+
+            const auto* data = buffer.getReadPointer (0);
+            captured.insert (captured.end(), data, data + blockSize);
+        }
+
+        drain (voice, buffer);
+        return captured;
+    }
+
+    int firstSound (const std::vector<float>& x)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+            if (std::abs (x[i]) > 1.0e-6f)
+                return (int) i;
+        return -1;
+    }
+}
+
+int main()
+{
+    SpeakNSpellVoice voice;
+    voice.setSampleRate (48000.0);
+    voice.setNoteText ("ah", {});
+
+    // The note utterance renders on the worker; a successful noteOn means it has arrived.
+    juce::AudioBuffer<float> buffer (1, 480);
+    const auto deadline = juce::Time::getMillisecondCounter() + 20000;
+    bool ready = false;
+    while (! ready && juce::Time::getMillisecondCounter() < deadline)
+    {
+        voice.render (buffer, 0, 480);
+        ready = voice.noteOn (60, 1.0f);
+        if (! ready)
+            juce::Thread::sleep (10);
+    }
+
+    if (! ready)
+    {
+        std::printf ("FAIL the note utterance never rendered\n");
+        return 1;
+    }
+
+    drain (voice, buffer);
+
+    const auto reference = playNoteAt (voice, 4096, 0);
+    const auto lead = firstSound (reference);
+    if (lead < 0)
+    {
+        std::printf ("FAIL the reference note is silent\n");
+        return 1;
+    }
+
+    int failures = 0, cases = 0;
+
+    for (int blockSize : { 32, 64, 441, 512, 1024, 4096 })
+        for (int onset : { 1, 17, blockSize - 1, blockSize, blockSize + 5, 3 * blockSize / 2 })
+        {
+            const auto output = playNoteAt (voice, blockSize, onset);
+            const auto heard = firstSound (output);
+
+            float worst = 0.0f;
+            for (int i = 0; i < captureLength; ++i)
+                worst = juce::jmax (worst, std::abs (output[(size_t) (onset + i)] - reference[(size_t) i]));
+
+            ++cases;
+            if (heard != onset + lead || worst > 1.0e-4f)
+            {
+                std::printf ("FAIL blocks of %d, note at %d: heard at %d, expected %d, max difference %g\n",
+                             blockSize, onset, heard, onset + lead, (double) worst);
+                ++failures;
+            }
+        }
+
+    std::printf ("%d onsets checked, %d off\n", cases, failures);
+    return failures == 0 ? 0 : 1;
+}
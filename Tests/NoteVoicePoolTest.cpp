@@ -0,0 +1,40 @@
+#include "NoteVoicePool.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Steals the only voice of a one-voice pool mid-waveform and fails if the output jumps
+// by more than the waveform itself moves from one sample to the next.
+int main()
+{
+    std::vector<uint8_t> pcm (22050);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = static_cast<uint8_t> (128.0 + 100.0 * std::sin ((double) i * 0.05));
+
+    Pcm8Interpolator interpolator;
+    interpolator.prepare (22050.0, 48000.0, PolyphaseResampler::Quality::standard);
+
+    NoteVoicePool pool;
+    pool.setSampleRate (48000.0);
+    pool.setVoiceLimit (1);
+
+    constexpr int stealAt = 1000, numSamples = 4800;
+    constexpr double step = 22050.0 / 48000.0;
+    std::vector<float> out (numSamples, 0.0f);
+
+    pool.noteOn (60, 1.0f, { pcm.data(), pcm.size(), 0 }, true);
+    pool.render (out.data(), stealAt, step, interpolator);
+    pool.noteOn (67, 1.0f, { pcm.data(), pcm.size(), 0 }, true);
+    pool.render (out.data() + stealAt, numSamples - stealAt, step, interpolator);
+
+    float worstJump = 0.0f;
+    for (int i = 1; i < numSamples; ++i)
+        worstJump = juce::jmax (worstJump, std::abs (out[(size_t) i] - out[(size_t) i - 1]));
+
+    // A 0.05 rad/sample sine at this amplitude moves at most about 0.05 per sample, and
+    // two of them overlap during the fade.
+    const auto active = pool.getNumActiveVoices();
+    std::printf ("largest step between samples %.4f, %d voice(s) sounding after the steal\n", (double) worstJump, active);
+
+    return worstJump < 0.1f && active == 1 ? 0 : 1;
+}
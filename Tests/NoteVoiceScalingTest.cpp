@@ -0,0 +1,85 @@
+#include "NoteVoicePool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+// Times NoteVoicePool::render in ns per 512-sample block with 1 to 32 looping notes
+// held, and prints each count against a straight line through the 1-note and 32-note
+// timings, so a cost that grows faster than the number of voices shows up as a widening
+// gap. Only the check that every held note is still sounding can fail; the timings are
+// for reading.
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 500;
+
+    // Fastest of five rounds, so a descheduled round doesn't count.
+    template <typename Fn>
+    double nanosecondsPerBlock (Fn&& fn)
+    {
+        constexpr int rounds = 5;
+        double fastest = 0.0;
+        for (int round = 0; round < rounds; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (int b = 0; b < numBlocks / rounds; ++b)
+                fn();
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            fastest = round == 0 ? elapsed.count() : juce::jmin (fastest, elapsed.count());
+        }
+        return fastest / (numBlocks / rounds);
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> pcm (22050);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = static_cast<uint8_t> (128.0 + 100.0 * std::sin ((double) i * 0.05));
+
+    Pcm8Interpolator interpolator;
+    interpolator.prepare (22050.0, sampleRate, PolyphaseResampler::Quality::standard);
+    constexpr double step = 22050.0 / sampleRate;
+
+    std::vector<float> out (blockSize);
+    const int counts[] = { 1, 2, 4, 8, 16, 32 };
+    double timings[std::size (counts)] {};
+    int failures = 0;
+
+    for (size_t c = 0; c < std::size (counts); ++c)
+    {
+        const auto numNotes = counts[c];
+
+        NoteVoicePool pool;
+        pool.setSampleRate (sampleRate);
+        pool.setVoiceLimit (numNotes);
+
+        // Spread over three octaves, so the voices step through the source at different rates.
+        for (int n = 0; n < numNotes; ++n)
+            pool.noteOn (48 + n, 0.5f, { pcm.data(), pcm.size(), 0 }, true);
+
+        timings[c] = nanosecondsPerBlock ([&]
+        {
+            std::fill (out.begin(), out.end(), 0.0f);
+            pool.render (out.data(), blockSize, step, interpolator);
+        });
+
+        if (pool.getNumActiveVoices() != numNotes)
+        {
+            std::printf ("FAIL %d notes held, %d sounding\n", numNotes, pool.getNumActiveVoices());
+            ++failures;
+        }
+    }
+
+    const auto perVoice = (timings[std::size (counts) - 1] - timings[0]) / (counts[std::size (counts) - 1] - 1);
+    std::printf ("%6s %12s %12s %10s\n", "notes", "ns/block", "linear", "ns/note");
+    for (size_t c = 0; c < std::size (counts); ++c)
+        std::printf ("%6d %12.0f %12.0f %10.0f\n", counts[c], timings[c],
+                     timings[0] + perVoice * (counts[c] - 1), timings[c] / counts[c]);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "Pcm8Interpolator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Times Pcm8Interpolator::process converting two seconds of SAM's 22050 Hz 8-bit PCM to
+// 44.1, 48 and 96 kHz in 512-sample chunks, in ns per output sample, against the two
+// passes it replaced: decode the phrase to floats, then resample those into a second
+// buffer through a kernel of the same size. Only the check that the chunked output
+// matches per-sample read() can fail; the timings are for reading.
+namespace
+{
+    constexpr double sourceRate = 22050.0;
+    constexpr int chunkSize = 512;
+    constexpr int numPhases = 1024;
+
+    // The old path, kept as a reference: a fresh buffer and a full pass per stage. The
+    // interpolator's kernels are private, so this one only matches their size and shape.
+    struct TwoPassResampler
+    {
+        TwoPassResampler (double step, PolyphaseResampler::Quality quality)
+            : numTaps (quality == PolyphaseResampler::Quality::high ? 48 : 16),
+              coeffs (static_cast<size_t> (numPhases * numTaps))
+        {
+            const auto cutoff = 0.9 * juce::jmin (1.0, 1.0 / step);
+            for (int phase = 0; phase < numPhases; ++phase)
+            {
+                for (int m = 0; m < numTaps; ++m)
+                {
+                    const auto d = static_cast<double> (phase) / numPhases - numTaps / 2 + (numTaps - 1 - m);
+                    const auto x = juce::MathConstants<double>::pi * cutoff * d;
+                    const auto window = 0.5 + 0.5 * std::cos (juce::MathConstants<double>::pi * d / (numTaps / 2 + 1));
+                    coeffs[static_cast<size_t> (phase * numTaps + m)] = static_cast<float> (cutoff * (x == 0.0 ? 1.0 : std::sin (x) / x) * window);
+                }
+            }
+        }
+
+        void process (const std::vector<uint8_t>& pcm, double step, int numOut)
+        {
+            std::vector<float> decoded (pcm.size());
+            for (size_t i = 0; i < pcm.size(); ++i)
+                decoded[i] = Pcm8Interpolator::decode (pcm[i]);
+
+            resampled = std::vector<float> (static_cast<size_t> (numOut));
+            const auto numSamples = static_cast<int64_t> (decoded.size());
+            for (int j = 0; j < numOut; ++j)
+            {
+                const auto index = static_cast<int64_t> (j * step * numPhases + 0.5);
+                const auto first = index / numPhases + numTaps / 2 - numTaps + 1;
+                const auto* row = coeffs.data() + static_cast<size_t> (index % numPhases) * static_cast<size_t> (numTaps);
+
+                float sum = 0.0f;
+                if (first >= 0 && first + numTaps <= numSamples)
+                {
+                    for (int m = 0; m < numTaps; ++m)
+                        sum += decoded[static_cast<size_t> (first + m)] * row[m];
+                }
+                else
+                {
+                    for (int m = 0; m < numTaps; ++m)
+                        if (first + m >= 0 && first + m < numSamples)
+                            sum += decoded[static_cast<size_t> (first + m)] * row[m];
+                }
+
+                resampled[static_cast<size_t> (j)] = sum;
+            }
+        }
+
+        int numTaps;
+        std::vector<float> coeffs, resampled;
+    };
+
+    // Fastest of five rounds, so a descheduled round doesn't count.
+    template <typename Fn>
+    double fastestOfFive (Fn&& fn)
+    {
+        double fastest = 0.0;
+        for (int round = 0; round < 5; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            fastest = round == 0 ? elapsed.count() : juce::jmin (fastest, elapsed.count());
+        }
+        return fastest;
+    }
+
+    // Keeps the reference output alive so the compiler can't drop the work.
+    volatile float sink = 0.0f;
+
+    const char* getName (PolyphaseResampler::Quality quality)
+    {
+        switch (quality)
+        {
+            case PolyphaseResampler::Quality::linear:   return "linear";
+            case PolyphaseResampler::Quality::standard: return "standard";
+            case PolyphaseResampler::Quality::high:     return "high";
+        }
+        return "";
+    }
+}
+
+int main()
+{
+    // A gliding tone with some grit, so the bytes cover the range the way speech does.
+    std::vector<uint8_t> pcm (static_cast<size_t> (2.0 * sourceRate));
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = static_cast<uint8_t> (128.0 + 90.0 * std::sin (1.0e-5 * (double) (i * i)) + (double) ((i * 7919) % 17) - 8.0);
+
+    int failures = 0;
+    std::printf ("%7s %9s %10s %10s\n", "rate", "quality", "fused", "two-pass");
+
+    for (const auto targetRate : { 44100.0, 48000.0, 96000.0 })
+    {
+        const auto step = sourceRate / targetRate;
+        const auto numOut = static_cast<int> (static_cast<double> (pcm.size()) / step);
+        std::vector<float> out (static_cast<size_t> (numOut));
+
+        for (const auto quality : { PolyphaseResampler::Quality::linear, PolyphaseResampler::Quality::standard,
+                                    PolyphaseResampler::Quality::high })
+        {
+            Pcm8Interpolator interpolator;
+            interpolator.prepare (sourceRate, targetRate, quality);
+
+            const auto fusedNs = fastestOfFive ([&]
+            {
+                auto position = 0.0;
+                for (int i = 0; i < numOut; i += chunkSize)
+                    position = interpolator.process (pcm.data(), pcm.size(), position, step, out.data() + i,
+                                                     juce::jmin (chunkSize, numOut - i));
+            });
+
+            // Runs inside the buffer step a fixed-point position, which can round to the
+            // neighbouring phase, so they match read() to the kernel's phase spacing.
+            float worst = 0.0f;
+            for (int i = 0; i < numOut; ++i)
+                worst = juce::jmax (worst, std::abs (out[(size_t) i] - interpolator.read (pcm.data(), pcm.size(), i * step)));
+
+            if (worst > 1.0e-3f)
+            {
+                std::printf ("FAIL %.0f Hz %s: chunks differ from read() by up to %g\n", targetRate, getName (quality), (double) worst);
+                ++failures;
+            }
+
+            if (quality == PolyphaseResampler::Quality::linear)
+            {
+                std::printf ("%7.0f %9s %10.2f %10s\n", targetRate, getName (quality), fusedNs / numOut, "-");
+                continue;
+            }
+
+            auto reference = std::make_unique<TwoPassResampler> (step, quality);
+            const auto twoPassNs = fastestOfFive ([&] { reference->process (pcm, step, numOut); });
+            sink = reference->resampled[(size_t) numOut / 2];
+
+            std::printf ("%7.0f %9s %10.2f %10.2f\n", targetRate, getName (quality), fusedNs / numOut, twoPassNs / numOut);
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
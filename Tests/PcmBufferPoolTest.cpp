@@ -0,0 +1,58 @@
+#include "PcmBufferPool.h"
+#include <cstdio>
+
+// Plays the render worker's pattern against the pool: a roomy buffer for each render,
+// grown as the stream arrives, then a fitted copy for the cache. Fails if cache copies
+// keep more than an eighth of slack, or if the pool still allocates once warm.
+int main()
+{
+    PcmBufferPool pool;
+    int failures = 0;
+
+    const size_t phraseLengths[] { 30000, 61000, 12000, 45000, 88000, 7000 };
+    std::vector<PcmBufferPool::Buffer> cached;
+    uint64_t allocationsAfterWarmUp = 0;
+
+    for (int round = 0; round < 6; ++round)
+    {
+        // The cache holds on to the last round's phrases while this one renders.
+        std::vector<PcmBufferPool::Buffer> stillCached;
+
+        for (auto length : phraseLengths)
+        {
+            auto render = pool.acquire (44100);
+            for (size_t done = 0; done < length; done += 512)
+            {
+                const auto chunk = juce::jmin<size_t> (512, length - done);
+                pool.reserve (render, render->size() + chunk);
+                render->insert (render->end(), chunk, uint8_t { 128 });
+            }
+
+            auto fitted = pool.acquireFitted (render->size());
+            fitted->assign (render->begin(), render->end());
+
+            if (fitted->capacity() > length + length / 8)
+            {
+                std::printf ("FAIL %zu byte phrase cached in a %zu byte buffer\n", length, fitted->capacity());
+                ++failures;
+            }
+
+            stillCached.push_back (std::move (fitted));
+        }
+
+        cached = std::move (stillCached);
+
+        if (round == 1)
+            allocationsAfterWarmUp = pool.getStats().allocations;
+    }
+
+    const auto stats = pool.getStats();
+    std::printf ("%zu buffers, %zu bytes, %llu reuses, %llu allocations after warming up\n",
+                 stats.buffers, stats.bytes, (unsigned long long) stats.reuses,
+                 (unsigned long long) (stats.allocations - allocationsAfterWarmUp));
+
+    if (stats.allocations != allocationsAfterWarmUp)
+        ++failures;
+
+    return failures == 0 ? 0 : 1;
+}
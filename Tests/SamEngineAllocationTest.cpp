@@ -0,0 +1,79 @@
+#include "SamEngine.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Renders the same phrases over and over into one buffer, the way the render worker
+// does, and fails if the engine still allocates once it has seen the longest of them.
+namespace
+{
+    size_t allocations = 0;
+
+    void* allocate (std::size_t size)
+    {
+        ++allocations;
+        if (auto* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new (std::size_t size)                   { return allocate (size); }
+void* operator new[] (std::size_t size)                 { return allocate (size); }
+void operator delete (void* p) noexcept                 { std::free (p); }
+void operator delete[] (void* p) noexcept               { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept    { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept  { std::free (p); }
+
+int main()
+{
+    const std::vector<std::string> phrases { "Hello, my name is Sam.",
+                                             "The quick brown fox jumps over the lazy dog!",
+                                             "Testing one two three.",
+                                             "Spell the word: necessary." };
+
+    SamEngine::Settings settings;
+    SamEngine::Settings phonetic;
+    phonetic.phoneticInput = true;
+    const std::string phoneticText = "/HEH3LOW DHEH4R.";
+
+    size_t streamed = 0;
+    const SamEngine::ChunkCallback onChunk = [&streamed] (const uint8_t*, size_t numBytes)
+    {
+        streamed += numBytes;
+        return true;
+    };
+
+    std::vector<uint8_t> pcm;
+    std::string error;
+    size_t warmUp = 0, steady = 0;
+
+    for (int round = 0; round < 4; ++round)
+    {
+        allocations = 0;
+
+        for (const auto& text : phrases)
+        {
+            error = SamEngine::renderInto (text, settings, nullptr, pcm);
+            error = SamEngine::renderInto (text, settings, onChunk, pcm);
+        }
+
+        error = SamEngine::renderInto (phoneticText, phonetic, nullptr, pcm);
+
+        // The first round sizes the per-thread scratch; after that nothing should grow.
+        (round == 0 ? warmUp : steady) += allocations;
+    }
+
+    std::printf ("%zu allocations while warming up, %zu in three steady rounds, %zu bytes streamed\n",
+                 warmUp, steady, streamed);
+
+    if (pcm.empty() || streamed == 0)
+    {
+        std::printf ("FAIL the engine produced no audio\n");
+        return 1;
+    }
+
+    return steady == 0 ? 0 : 1;
+}
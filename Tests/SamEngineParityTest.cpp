@@ -0,0 +1,184 @@
+#include "SamEngine.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined (_WIN32)
+ #include <process.h>
+#else
+ #include <spawn.h>
+ #include <sys/wait.h>
+ extern char** environ;
+#endif
+
+// Renders every line of a corpus with SamEngine and with `node sam_bridge.js`, and
+// fails unless the classic backend's 8-bit output matches byte for byte.
+//
+// usage: SamEngineParityTest <node> <sam_bridge.js> <corpus.tsv> <scratch directory>
+//
+// Corpus lines are speed, pitch, mouth, throat, sing, phonetic and the text, separated
+// by tabs; lines starting with '#' are skipped.
+namespace
+{
+    struct Case
+    {
+        std::vector<std::string> fields;
+        std::string text;
+    };
+
+    std::vector<Case> readCorpus (const std::string& path)
+    {
+        std::vector<Case> cases;
+        std::ifstream in (path);
+        std::string line;
+
+        while (std::getline (in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            Case c;
+            std::stringstream fields (line);
+            std::string field;
+            while (std::getline (fields, field, '\t'))
+            {
+                if (c.fields.size() < 6)
+                    c.fields.push_back (field);
+                else
+                    c.text += (c.text.empty() ? "" : " ") + field;
+            }
+
+            if (c.fields.size() == 6)
+                cases.push_back (std::move (c));
+        }
+
+        return cases;
+    }
+
+    // Runs the bridge the way the Node backend always has: one process per phrase, with
+    // the PCM written to a file. Returns the process exit code.
+    int runBridge (const std::vector<std::string>& args)
+    {
+       #if defined (_WIN32)
+        // _spawnv joins its arguments with spaces, so each one is quoted here.
+        std::vector<std::string> quoted;
+        for (const auto& arg : args)
+        {
+            std::string q = "\"";
+            for (auto ch : arg)
+                q += ch == '"' ? std::string ("\\\"") : std::string (1, ch);
+            quoted.push_back (q + "\"");
+        }
+
+        std::vector<const char*> argv;
+        for (const auto& arg : quoted)
+            argv.push_back (arg.c_str());
+        argv.push_back (nullptr);
+
+        return static_cast<int> (_spawnv (_P_WAIT, args[0].c_str(), argv.data()));
+       #else
+        std::vector<char*> argv;
+        for (const auto& arg : args)
+            argv.push_back (const_cast<char*> (arg.c_str()));
+        argv.push_back (nullptr);
+
+        pid_t pid = 0;
+        if (posix_spawnp (&pid, args[0].c_str(), nullptr, nullptr, argv.data(), environ) != 0)
+            return -1;
+
+        int status = 0;
+        if (waitpid (pid, &status, 0) != pid || ! WIFEXITED (status))
+            return -1;
+
+        return WEXITSTATUS (status);
+       #endif
+    }
+
+    std::vector<uint8_t> readFile (const std::string& path)
+    {
+        std::ifstream in (path, std::ios::binary);
+        return { std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char>() };
+    }
+
+    std::string describe (const Case& c)
+    {
+        std::string s;
+        for (const auto& field : c.fields)
+            s += field + " ";
+        return s + "\"" + c.text + "\"";
+    }
+}
+
+int main (int argc, char** argv)
+{
+    if (argc < 5)
+    {
+        std::cerr << "usage: SamEngineParityTest <node> <sam_bridge.js> <corpus.tsv> <scratch directory>\n";
+        return 2;
+    }
+
+    const std::string node = argv[1], bridge = argv[2];
+    const auto outPath = std::string (argv[4]) + "/sam_parity.pcm";
+    const auto cases = readCorpus (argv[3]);
+    if (cases.empty())
+    {
+        std::cerr << "No cases in " << argv[3] << "\n";
+        return 2;
+    }
+
+    int failures = 0, rendered = 0;
+
+    for (const auto& c : cases)
+    {
+        std::remove (outPath.c_str());
+        std::remove ((outPath + ".err.txt").c_str());
+
+        const auto exitCode = runBridge ({ node, bridge, outPath, c.fields[0], c.fields[1], c.fields[2], c.fields[3],
+                                           c.fields[4], c.fields[5], "classic", c.text });
+        const auto expected = readFile (outPath);
+
+        SamEngine::Settings settings;
+        settings.speed = std::stoi (c.fields[0]);
+        settings.pitch = std::stoi (c.fields[1]);
+        settings.mouth = std::stoi (c.fields[2]);
+        settings.throat = std::stoi (c.fields[3]);
+        settings.singMode = c.fields[4] == "1";
+        settings.phoneticInput = c.fields[5] == "1";
+        const auto actual = SamEngine::render (c.text, settings);
+
+        // The bridge writes nothing for empty text and an .err.txt file when SAM fails;
+        // either way the engine has to come back empty too.
+        if (exitCode < 0)
+        {
+            std::cerr << "Could not run " << node << "\n";
+            return 2;
+        }
+
+        if (actual.pcm != expected)
+        {
+            ++failures;
+            std::cerr << "MISMATCH " << describe (c) << ": node " << expected.size() << " bytes (exit " << exitCode
+                      << "), engine " << actual.pcm.size() << " bytes";
+
+            size_t i = 0;
+            while (i < expected.size() && i < actual.pcm.size() && expected[i] == actual.pcm[i])
+                ++i;
+            std::cerr << ", first difference at byte " << i;
+            if (! actual.error.empty())
+                std::cerr << ", engine error: " << actual.error;
+            std::cerr << "\n";
+        }
+
+        rendered += expected.empty() ? 0 : 1;
+    }
+
+    std::remove (outPath.c_str());
+    std::remove ((outPath + ".err.txt").c_str());
+
+    std::cout << cases.size() << " cases, " << rendered << " with audio, " << failures << " mismatched\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include "SamNodeWorker.h"
+#include <cstdio>
+#include <vector>
+
+// Renders the same phrases through the resident `sam_bridge.js --server` worker and by
+// starting one Node process per phrase, the way the Node backends used to, for both
+// backends. Fails unless the two agree byte for byte, and prints the time per phrase.
+namespace
+{
+    // Node process start-up plus module loading, with the PCM handed back through a file.
+    juce::String renderBySpawning (const juce::String& node, const juce::File& script, const SamNodeWorker::Request& request,
+                                   std::vector<uint8_t>& pcm)
+    {
+        const auto outFile = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                 .getNonexistentChildFile ("sam-node-test-", ".pcm", false);
+
+        juce::StringArray args;
+        args.add (node);
+        args.add (script.getFullPathName());
+        args.add (outFile.getFullPathName());
+        args.add (juce::String (request.speed));
+        args.add (juce::String (request.pitch));
+        args.add (juce::String (request.mouth));
+        args.add (juce::String (request.throat));
+        args.add (request.singMode ? "1" : "0");
+        args.add (request.phoneticInput ? "1" : "0");
+        args.add (request.betterBackend ? "better" : "classic");
+        args.add (request.text);
+
+        juce::ChildProcess process;
+        if (! process.start (args, juce::ChildProcess::wantStdOut))
+            return "could not start " + node;
+
+        (void) process.readAllProcessOutput();
+        if (! process.waitForProcessToFinish (12000))
+        {
+            process.kill();
+            return "timed out";
+        }
+
+        juce::MemoryBlock data;
+        const auto loaded = outFile.loadFileAsData (data);
+        outFile.deleteFile();
+        outFile.getSiblingFile (outFile.getFileName() + ".err.txt").deleteFile();
+        if (! loaded)
+            return "no output";
+
+        const auto* bytes = static_cast<const uint8_t*> (data.getData());
+        pcm.assign (bytes, bytes + data.getSize());
+        return {};
+    }
+}
+
+int main()
+{
+    const juce::String node (SAM_NODE_EXECUTABLE);
+    const auto script = juce::File (SAM_PROJECT_ROOT).getChildFile ("Source/sam_bridge.js");
+
+    const char* phrases[] { "Hello, my name is Sam.",
+                            "The quick brown fox jumps over the lazy dog.",
+                            "Testing one two three.",
+                            "Please spell the word necessary.",
+                            "I am a speech synthesizer." };
+    constexpr int rounds = 4;
+
+    int failures = 0;
+    SamNodeWorker worker;
+
+    for (const auto betterBackend : { false, true })
+    {
+        double spawnMs = 0.0, serverMs = 0.0, firstServerMs = 0.0;
+        int renders = 0;
+
+        // The first server render includes starting the worker, so it is timed apart.
+        SamNodeWorker::Request warmUp;
+        warmUp.text = "Hello.";
+        warmUp.betterBackend = betterBackend;
+        std::vector<uint8_t> ignored;
+        worker.stop();
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        if (const auto error = worker.render (node, script, warmUp, 12000, ignored); error.isNotEmpty())
+        {
+            std::printf ("FAIL the server did not start: %s\n", error.toRawUTF8());
+            return 1;
+        }
+        firstServerMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (const auto* text : phrases)
+            {
+                SamNodeWorker::Request request;
+                request.text = text;
+                request.speed = 60 + 8 * round;
+                request.pitch = 50 + 10 * round;
+                request.betterBackend = betterBackend;
+
+                std::vector<uint8_t> spawned, served;
+
+                start = juce::Time::getMillisecondCounterHiRes();
+                const auto spawnError = renderBySpawning (node, script, request, spawned);
+                spawnMs += juce::Time::getMillisecondCounterHiRes() - start;
+
+                start = juce::Time::getMillisecondCounterHiRes();
+                const auto serverError = worker.render (node, script, request, 12000, served);
+                serverMs += juce::Time::getMillisecondCounterHiRes() - start;
+
+                ++renders;
+                if (spawnError.isNotEmpty() || serverError.isNotEmpty() || spawned.empty() || spawned != served)
+                {
+                    std::printf ("FAIL \"%s\": spawned %zu bytes (%s), server %zu bytes (%s)\n", text,
+                                 spawned.size(), spawnError.toRawUTF8(), served.size(), serverError.toRawUTF8());
+                    ++failures;
+                }
+            }
+        }
+
+        std::printf ("%s: spawn per phrase %.1f ms, server %.1f ms per phrase over %d phrases; server start-up %.1f ms\n",
+                     betterBackend ? "better" : "classic", spawnMs / renders, serverMs / renders, renders, firstServerMs);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
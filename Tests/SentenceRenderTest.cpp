@@ -0,0 +1,120 @@
+#include "SpeakNSpellVoice.h"
+#include <cstdio>
+
+// Queues a two-sentence phrase, which the worker renders sentence by sentence, and fails
+// unless what it queues is both sentences joined by the phrase gap: first as it streams,
+// then again when the same text is played from the render cache. Then times a paragraph
+// through the voice, with later sentences on the shared sentence pool, against one
+// serial SamEngine render of the same text.
+namespace
+{
+    constexpr auto twoSentences = "Hello world. Testing one two three.";
+
+    constexpr auto paragraph = "The quick brown fox jumps over the lazy dog. Please spell the word necessary. "
+                               "I am a speech synthesizer from nineteen eighty two. Testing one two three. "
+                               "My name is Sam, and I can say almost anything you type. "
+                               "The rain in Spain stays mainly in the plain. Goodbye for now.";
+
+    // Scratch packs, so no sentence can come from an earlier run's disk cache.
+    juce::File makeScratchPack()
+    {
+        return juce::File::getSpecialLocation (juce::File::tempDirectory)
+                   .getNonexistentChildFile ("sam-sentence-test-", ".pack", false);
+    }
+
+    // Nothing plays the queued audio, so each render is only counted. Notes when the
+    // first of the phrase was queued, if asked.
+    bool waitForRenders (SpeakNSpellVoice& voice, juce::uint32 count, double* firstAudioMs = nullptr)
+    {
+        const auto deadline = juce::Time::getMillisecondCounter() + 20000;
+        while (voice.getStatusCounters().renders + voice.getStatusCounters().failures < count)
+        {
+            if (firstAudioMs != nullptr && *firstAudioMs < 0.0 && voice.getQueueDepthSamples() > 0)
+                *firstAudioMs = juce::Time::getMillisecondCounterHiRes();
+
+            if (juce::Time::getMillisecondCounter() > deadline)
+                return false;
+            juce::Thread::sleep (1);
+        }
+
+        return voice.getStatusCounters().failures == 0;
+    }
+}
+
+int main()
+{
+    const SamEngine::Settings settings;
+    const auto gap = static_cast<juce::int64> (0.04 * SamEngine::outputSampleRate);
+    const auto expected = static_cast<juce::int64> (SamEngine::render ("Hello world.", settings).pcm.size())
+                        + gap + static_cast<juce::int64> (SamEngine::render ("Testing one two three.", settings).pcm.size())
+                        + gap;
+
+    int failures = 0;
+    {
+        const auto pack = makeScratchPack();
+        SpeakNSpellVoice voice (pack);
+        voice.setSampleRate (48000.0);
+
+        for (juce::uint32 round = 1; round <= 2; ++round)
+        {
+            voice.queueText (twoSentences, {});
+            const auto finished = waitForRenders (voice, round);
+            const auto queued = voice.getStatusCounters().queuedSamples;
+
+            std::printf ("%s: queued %lld samples, expected %lld (status \"%s\")\n", round == 1 ? "streamed" : "from the cache",
+                         queued, expected, voice.getStatusText().toRawUTF8());
+
+            if (! finished || queued != expected)
+                ++failures;
+        }
+
+        pack.deleteFile();
+    }
+
+    constexpr int runs = 3;
+    double serialMs = 0.0, voiceMs = 0.0, firstAudioMs = 0.0;
+    size_t serialSamples = 0;
+
+    (void) SamEngine::render (paragraph, settings);
+    for (int run = 0; run < runs; ++run)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        serialSamples = SamEngine::render (paragraph, settings).pcm.size();
+        serialMs += juce::Time::getMillisecondCounterHiRes() - start;
+    }
+
+    juce::int64 voiceSamples = 0;
+    for (int run = 0; run < runs; ++run)
+    {
+        const auto pack = makeScratchPack();
+        {
+            SpeakNSpellVoice voice (pack);
+            voice.setSampleRate (48000.0);
+
+            double firstAudioAt = -1.0;
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            voice.queueText (paragraph, {});
+            if (! waitForRenders (voice, 1, &firstAudioAt))
+            {
+                std::printf ("FAIL the paragraph did not render\n");
+                ++failures;
+                break;
+            }
+
+            voiceMs += juce::Time::getMillisecondCounterHiRes() - start;
+            firstAudioMs += firstAudioAt - start;
+            voiceSamples = voice.getStatusCounters().queuedSamples;
+        }
+        pack.deleteFile();
+    }
+
+    std::printf ("%.1f s paragraph: one serial render %.1f ms; sentence by sentence on %d pool thread(s) %.1f ms, "
+                 "first audio after %.1f ms (%.2fx)\n",
+                 static_cast<double> (serialSamples) / SamEngine::outputSampleRate, serialMs / runs,
+                 juce::jmax (1, juce::SystemStats::getNumCpus() - 1), voiceMs / runs, firstAudioMs / runs, serialMs / voiceMs);
+
+    if (voiceSamples <= 0)
+        ++failures;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include "SpeakNSpellVoice.h"
+#include <cstdio>
+
+// Floods the voice with text while nothing plays, so the queued audio stays over its
+// budget and playback jobs are held back, and checks that:
+//  - dropping the oldest text keeps taking new text without ever reporting a full queue;
+//  - a note job still renders behind the held-back playback jobs;
+//  - dropping the newest text does report the queue as full.
+// Then queues more short phrases than there are phrase slots, well inside the budget,
+// and checks that a note job still renders once the slots are all taken.
+namespace
+{
+    bool waitForNoteText (SpeakNSpellVoice& voice)
+    {
+        const auto deadline = juce::Time::getMillisecondCounter() + 20000;
+        while (juce::Time::getMillisecondCounter() < deadline)
+        {
+            if (voice.noteOn (60, 1.0f))
+                return true;
+            juce::Thread::sleep (10);
+        }
+
+        return false;
+    }
+}
+
+int main()
+{
+    SpeakNSpellVoice voice;
+    voice.setSampleRate (48000.0);
+
+    SpeakNSpellVoice::QueueLimits limits;
+    limits.maxQueuedSeconds = 0.5;
+    limits.maxPendingJobs = 2;
+    limits.policy = SpeakNSpellVoice::QueuePolicy::dropOldest;
+    voice.setQueueLimits (limits);
+
+    int failures = 0;
+    const SpeakNSpellVoice::Parameters params;
+
+    for (int i = 0; i < 50; ++i)
+    {
+        voice.queueText ("Message number " + juce::String (i) + ".", params);
+        if (voice.getStatus() == SpeakNSpellVoice::Status::queueFull)
+        {
+            std::printf ("FAIL drop-oldest reported a full queue at message %d\n", i);
+            ++failures;
+            break;
+        }
+    }
+
+    // The first message renders and puts the queue over budget; nothing plays it.
+    voice.setNoteText ("la", params);
+
+    if (! waitForNoteText (voice))
+    {
+        std::printf ("FAIL the note text never rendered behind the held-back playback jobs\n");
+        ++failures;
+    }
+
+    const auto afterFlood = voice.getQueueCounters();
+    if (afterFlood.dropped < 40)
+    {
+        std::printf ("FAIL only %u of 50 messages were dropped\n", afterFlood.dropped);
+        ++failures;
+    }
+
+    limits.policy = SpeakNSpellVoice::QueuePolicy::dropNewest;
+    voice.setQueueLimits (limits);
+    voice.queueText ("One more message.", params);
+
+    if (voice.getStatus() != SpeakNSpellVoice::Status::queueFull || voice.getQueueCounters().dropped != afterFlood.dropped + 1)
+    {
+        std::printf ("FAIL drop-newest accepted text over the limit\n");
+        ++failures;
+    }
+
+    std::printf ("%u dropped, queue depth %.2f s, status \"%s\"\n", voice.getQueueCounters().dropped,
+                 voice.getQueueDepthSeconds(), voice.getStatusText().toRawUTF8());
+
+    {
+        SpeakNSpellVoice shortPhrases;
+        shortPhrases.setSampleRate (48000.0);
+        limits.maxQueuedSeconds = 600.0;
+        limits.maxPendingJobs = 8;
+        limits.policy = SpeakNSpellVoice::QueuePolicy::dropOldest;
+        shortPhrases.setQueueLimits (limits);
+
+        for (int i = 0; i < 20; ++i)
+        {
+            shortPhrases.queueText ("Hi " + juce::String (i) + ".", params);
+            juce::Thread::sleep (100);
+        }
+
+        shortPhrases.setNoteText ("la", params);
+        const auto noteReady = waitForNoteText (shortPhrases);
+
+        std::printf ("20 short phrases: %u rendered, queue depth %.2f s, note text %s\n", shortPhrases.getStatusCounters().renders,
+                     shortPhrases.getQueueDepthSeconds(), noteReady ? "rendered" : "stuck");
+
+        if (! noteReady)
+        {
+            std::printf ("FAIL the note text never rendered once the phrase slots were taken\n");
+            ++failures;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
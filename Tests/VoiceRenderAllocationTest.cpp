@@ -0,0 +1,104 @@
+#include "SpeakNSpellVoice.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Plays a phrase through to its loop point and a few held notes, with every effect
+// stage on, and fails if anything called from the audio thread allocates. Only the
+// thread running render() is counted; the render worker allocates freely.
+namespace
+{
+    thread_local bool countAllocations = false;
+    std::atomic<int> audioThreadAllocations { 0 };
+
+    void* allocate (std::size_t size)
+    {
+        if (countAllocations)
+            audioThreadAllocations.fetch_add (1);
+
+        if (auto* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    struct ScopedCount
+    {
+        ScopedCount()  { countAllocations = true; }
+        ~ScopedCount() { countAllocations = false; }
+    };
+}
+
+void* operator new (std::size_t size)                   { return allocate (size); }
+void* operator new[] (std::size_t size)                 { return allocate (size); }
+void operator delete (void* p) noexcept                 { std::free (p); }
+void operator delete[] (void* p) noexcept               { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept    { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept  { std::free (p); }
+
+int main()
+{
+    constexpr int blockSize = 480;
+    SpeakNSpellVoice voice;
+    voice.setSampleRate (48000.0);
+
+    SpeakNSpellVoice::RealtimeControls controls;
+    controls.playbackSpeed = 1.3f;
+    controls.repitchSemitones = 3.0f;
+    controls.formantWarp = 0.4f;
+    controls.glitchGate = 0.3f;
+    controls.bitCrush = 0.3f;
+    controls.microLoop = 0.3f;
+    controls.spectralTilt = 0.5f;
+    controls.ringMod = 0.4f;
+    controls.freqShift = 0.4f;
+    controls.repitchJitter = 0.5f;
+    voice.setRealtimeControls (controls);
+    voice.setLoopAtEnd (true);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    SpeakNSpellVoice::Parameters params;
+    voice.setNoteText ("la", params);
+    voice.queueText ("Hello world. Testing the status reporting.", params);
+
+    // Rendering happens on the worker, so blocks are pulled in roughly real time until
+    // the phrase has looped once or the deadline passes.
+    const auto deadline = juce::Time::getMillisecondCounter() + 20000;
+    float peak = 0.0f;
+    int blocks = 0;
+
+    while (voice.getStatusCounters().loops == 0 && juce::Time::getMillisecondCounter() < deadline)
+    {
+        buffer.clear();
+        {
+            const ScopedCount count;
+
+            if (blocks % 50 == 10)
+                voice.noteOn (60 + blocks % 12, 0.8f);
+            if (blocks % 50 == 40)
+                voice.allNotesOff();
+
+            voice.render (buffer, 0, blockSize);
+            (void) voice.getStatus();
+            (void) voice.getStatusCounters();
+            (void) voice.getQueueDepthSamples();
+        }
+
+        peak = juce::jmax (peak, buffer.getMagnitude (0, 0, blockSize));
+        ++blocks;
+        juce::Thread::sleep (blockSize * 1000 / 48000);
+    }
+
+    const auto counters = voice.getStatusCounters();
+    std::printf ("%d blocks, %u loops, peak %.3f, status \"%s\", %d allocations on the audio thread\n",
+                 blocks, counters.loops, (double) peak, voice.getStatusText().toRawUTF8(), audioThreadAllocations.load());
+
+    if (counters.loops == 0 || peak <= 0.0f)
+    {
+        std::printf ("FAIL the phrase never played through to its loop point\n");
+        return 1;
+    }
+
+    return audioThreadAllocations.load() == 0 ? 0 : 1;
+}